@@ -54,6 +54,8 @@ case "$NAME" in
 all)
   TST="\
   vc.tst
+  solve.tst
+  uct.tst
   ";;
 basics)
   # Tests in basics should be fast, specific and produce no unexpected fails
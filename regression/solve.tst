@@ -0,0 +1,68 @@
+#-----------------------------------------------------------------------------
+# Solver tests
+#
+# y_solve prints the winner, the winning move, the depth reached and the
+# number of nodes searched. For alpha-beta, compare the node counts with
+# 'y_param solver_move_ordering 0' to see the effect of move ordering.
+#-----------------------------------------------------------------------------
+
+#
+# Alpha-beta: the first player wins on the empty board
+#
+y_param solver alphabeta
+
+boardsize 4
+10 y_solve b
+#? [black [a-d][1-4] [0-9]+ [0-9]+]
+
+boardsize 5
+20 y_solve b
+#? [black [a-e][1-5] [0-9]+ [0-9]+]
+
+#
+# Alpha-beta without move ordering: the node counts of 30 and 40 are
+# larger than those of 10 and 20
+#
+y_param solver_move_ordering 0
+
+boardsize 4
+30 y_solve b
+#? [black [a-d][1-4] [0-9]+ [0-9]+]
+
+boardsize 5
+40 y_solve b
+#? [black [a-e][1-5] [0-9]+ [0-9]+]
+
+y_param solver_move_ordering 1
+
+#
+# Df-pn: the same positions
+#
+y_param solver dfpn
+
+boardsize 4
+110 y_solve b
+#? [black .*]
+
+boardsize 5
+120 y_solve b
+#? [black .*]
+
+boardsize 6
+130 y_solve b
+#? [black .*]
+
+#
+# Parallel df-pn: four workers sharing one table
+#
+y_param solver_threads 4
+
+boardsize 5
+220 y_solve b
+#? [black .*]
+
+boardsize 6
+230 y_solve b
+#? [black .*]
+
+y_param solver_threads 1
@@ -0,0 +1,45 @@
+#-----------------------------------------------------------------------------
+# UCT search tests
+#-----------------------------------------------------------------------------
+
+y_param max_games 2000
+y_param max_time 5
+
+#
+# White has two threats, d5 and f6, so the mustplay of black is empty.
+# The root must still get moves and genmove must play one of them.
+#
+boardsize 7
+play b a1
+play w a6
+play b c3
+play w b6
+play b b4
+play w c6
+play b e5
+play w d6
+play b g7
+play w e6
+play b a4
+play w b7
+play b b5
+play w d4
+
+10 genmove b
+#? [[a-g][1-7]]
+
+#
+# With the endgame database every position of size 4 is solved. The
+# root must still be expanded, so that genmove has a move to play and
+# y_solve a winning move to print.
+#
+endgame_db_build uct-test.egdb 4
+y_param endgame_db uct-test.egdb
+boardsize 4
+
+20 genmove b
+#? [[a-d][1-4]]
+
+clear_board
+30 y_solve b
+#? [black [a-d][1-4] .*]
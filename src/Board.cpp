@@ -43,6 +43,7 @@ void Board::State::Init(int T)
 }
 
 Board::Board(int size)
+    : m_statistics(0)
 { 
     SetSize(size);
 }
@@ -53,6 +54,7 @@ void Board::SetSize(int size)
     m_state.Init(m_constBrd.TotalCells);
     m_savePoint1.Init(m_constBrd.TotalCells);
     m_savePoint2.Init(m_constBrd.TotalCells);
+    m_mustplayState.Init(m_constBrd.TotalCells);
     
     const int N = Size();
 
@@ -615,7 +617,7 @@ void Board::Play(SgBlackWhite color, cell_t p)
     //          << "vcwin=" << HasWinningVC() << ' '
     //          << (HasWinningVC() ? ToString(m_state.m_vcStonePlayed) : "") 
     //          << '\n';
-    Statistics::Get().m_numMovesPlayed++;
+    Y_STAT(if (m_statistics) m_statistics->m_numMovesPlayed++;)
     m_dirtyConCells.Clear();
     m_dirtyWeightCells.Clear();
     m_dirtyBlocks.Clear();
@@ -906,6 +908,19 @@ int Board::SaveBridge(cell_t lastMove, const SgBlackWhite toPlay,
     return SG_NULLMOVE;
 }
 
+void Board::GetSymmetries(SymmetryList& symmetries) const
+{
+    symmetries.Clear();
+    for (int s = 1; s < ConstBoard::NUM_SYMMETRIES; ++s) {
+        bool symmetric = true;
+        for (CellIterator i(Const()); i && symmetric; ++i)
+            if (GetColor(*i) != GetColor(Const().Symmetric(*i, s)))
+                symmetric = false;
+        if (symmetric)
+            symmetries.PushBack(s);
+    }
+}
+
 bool Board::IsCellMarkedDead(cell_t p) const
 {
     return GetCell(p)->IsDead();
@@ -1003,6 +1018,68 @@ void Board::MarkAllThreats(const MarkedCellsWithList& cells,
     }
 }
 
+/** Borders that color would connect to by playing p: the edges and
+    groups p is fully connected to, skipping groups whose carrier
+    contains p. */
+int Board::ConnectedBorder(cell_t p, SgBlackWhite color) const
+{
+    int border = 0;
+    const Cell* cell = GetCell(p);
+    for (int i = 0; i < cell->m_FullConnects[color].Length(); ++i) {
+        const cell_t block = BlockAnchor(cell->m_FullConnects[color][i]);
+        if (ConstBoard::IsEdge(block))
+            border |= ConstBoard::ToBorderValue(block);
+        else {
+            const Group* g = BlockToGroup(block);
+            if (!g->m_carrier.Marked(p))
+                border |= g->m_border;
+        }
+    }
+    return border;
+}
+
+/** Every candidate win of the opponent is played out on the board and
+    undone by restoring m_mustplayState; only moves whose VC the board
+    detects count. Opponent wins that are missed just leave more
+    moves in the mustplay. */
+bool Board::ComputeMustplay(SgBlackWhite toPlay, MarkedCells& mustplay)
+{
+    SG_ASSERT(!HasWinningVC());
+    const SgBlackWhite opp = SgOppBW(toPlay);
+    SgArrayList<cell_t, Y_MAX_CELL> threats;
+    for (EmptyIterator it(*this); it; ++it) {
+        if (ConnectedBorder(*it, toPlay) == ConstBoard::BORDER_ALL)
+            return false;
+        if (ConnectedBorder(*it, opp) == ConstBoard::BORDER_ALL)
+            threats.PushBack(*it);
+    }
+    if (threats.IsEmpty())
+        return false;
+
+    mustplay.Clear();
+    for (EmptyIterator it(*this); it; ++it)
+        mustplay.Mark(*it);
+    const MarkedCellsWithList dirtyConCells(m_dirtyConCells);
+    const MarkedCellsWithList dirtyWeightCells(m_dirtyWeightCells);
+    const MarkedCellsWithList dirtyBlocks(m_dirtyBlocks);
+    CopyState(m_mustplayState, m_state);
+    bool restricted = false;
+    for (int i = 0; i < threats.Length(); ++i) {
+        Play(opp, threats[i]);
+        if (IsVCWinner(opp)) {
+            MarkedCells carrier(GroupCarrier(WinningVCStonePlayed()));
+            carrier.Mark(threats[i]);
+            mustplay.Intersect(carrier);
+            restricted = true;
+        }
+        CopyState(m_state, m_mustplayState);
+    }
+    m_dirtyConCells = dirtyConCells;
+    m_dirtyWeightCells = dirtyWeightCells;
+    m_dirtyBlocks = dirtyBlocks;
+    return restricted;
+}
+
 float Board::WeightCell(cell_t p) const
 {
     static float s_borderWeights[8]= 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -32,47 +33,61 @@ struct LocalMoves
     static const float WEIGHT_DEAD_CELL   = 1e-6;
     static const float WEIGHT_WIN_THREAT  = 1e+6;
 
-    std::vector<int> move;
-    std::vector<float> gamma;
+    /** GeneralSaveBridge() adds at most one move for each pair of
+        the (at most three) blocks around the last move. */
+    static const int MAX_MOVES = 8;
+
+    SgArrayList<cell_t, MAX_MOVES> move;
+    float gamma[MAX_MOVES];
     float gammaTotal;
-    
+
+    /** Slot of each cell in move, or -1 if not present. */
+    int8_t slot[Y_MAX_CELL];
+
+    LocalMoves()
+        : gammaTotal(0.0f)
+    {
+        memset(slot, -1, sizeof(slot));
+    }
+
     void Clear()
     {
-        move.clear();
-        gamma.clear();
+        for (int i = 0; i < move.Length(); ++i)
+            slot[move[i]] = -1;
+        move.Clear();
         gammaTotal = 0.0f;
     }
 
+    int Length() const
+    { return move.Length(); }
+
     float Total() const 
     { return gammaTotal; }
 
     void AddWeight(cell_t p, float w)
     {
-        for (size_t i = 0; i < move.size(); ++i) {
-            if (move[i] == p) {
-                gamma[i] += w;
-                gammaTotal += w;
-                return;
-            }
-        }
-        move.push_back(p);
-        gamma.push_back(w);
         gammaTotal += w;
+        if (slot[p] >= 0) {
+            gamma[slot[p]] += w;
+            return;
+        }
+        slot[p] = static_cast<int8_t>(move.Length());
+        gamma[move.Length()] = w;
+        move.PushBack(p);
     }
 
-    SgMove Choose(float random)
+    /** Selects a move given random in [0, Total()).
+        The last move absorbs any rounding error in the walk. */
+    SgMove Choose(float random) const
     {
-        assert(!move.empty());
-
-        gamma.back() += 1.0; // ensure it doesn't go past end
-
-        int i = -1;
-        do {
-            random -= gamma[++i];
-        } while (random > 0.0001f);
-        
-        gamma.back() -= 1.0;
-
+        assert(!move.IsEmpty());
+        const int last = move.Length() - 1;
+        int i = 0;
+        for (; i < last; ++i) {
+            random -= gamma[i];
+            if (random <= 0.0001f)
+                break;
+        }
         return move[i];
     }
 };
@@ -136,6 +151,14 @@ struct Board
             m_numDirtyCellsPerMove = 0;
         }
 
+        void Add(const Statistics& other)
+        {
+            m_maxSharedLiberties = std::max(m_maxSharedLiberties, 
+                                            other.m_maxSharedLiberties);
+            m_numMovesPlayed += other.m_numMovesPlayed;
+            m_numDirtyCellsPerMove += other.m_numDirtyCellsPerMove;
+        }
+
         std::string ToString() const
         {
             std::ostringstream os;
@@ -146,12 +169,6 @@ struct Board
                << ']';
             return os.str();
         }
-
-        static Statistics& Get()
-        {
-            static Statistics s_stats;
-            return s_stats;
-        }
     };
 
     struct EmptyIterator : public MarkedCellsWithList::Iterator
@@ -197,6 +214,11 @@ struct Board
 
     const ConstBoard& Const() const { return m_constBrd; }
 
+    /** Counters updated by Play(); owned by the caller so that
+        search threads never share them. Pass 0 to stop counting. */
+    void SetStatistics(Statistics* stats) { m_statistics = stats; }
+    Statistics* GetStatistics() const     { return m_statistics; }
+
     void SetPosition(const Board& other);
     void SetSize(int size);
     int Size() const { return Const().Size(); }
@@ -208,6 +230,39 @@ struct Board
 
     SgHashCode Hash() const { return m_state.m_hash; };
 
+    /** Hash() after color plays at the empty cell p. */
+    SgHashCode HashAfterMove(cell_t p, SgBlackWhite color) const
+    {
+        SgHashCode hash = m_state.m_hash;
+        hash.Xor(HashForCell(p, color));
+        return hash;
+    }
+
+    //------------------------------------------------------------
+
+    typedef SgArrayList<int, ConstBoard::NUM_SYMMETRIES> SymmetryList;
+
+    /** Symmetries other than the identity that map every stone onto
+        a stone of the same color. */
+    void GetSymmetries(SymmetryList& symmetries) const;
+
+    /** True if no image of p under the given symmetries that is
+        smaller than p is itself a move: empty and, unless mustplay is
+        0, in the mustplay. Moves that are not can be skipped. A
+        mustplay need not be closed under the symmetries, so an image
+        outside of it does not stand in for p. */
+    bool IsSymmetryRepresentative(cell_t p, const SymmetryList& symmetries,
+                                  const MarkedCells* mustplay) const
+    {
+        for (int i = 0; i < symmetries.Length(); ++i)
+        {
+            const cell_t q = Const().Symmetric(p, symmetries[i]);
+            if (q < p && IsEmpty(q) && (mustplay == 0 || mustplay->Marked(q)))
+                return false;
+        }
+        return true;
+    }
+
     //------------------------------------------------------------
 
     bool IsGameOver() const { return m_state.m_winner != SG_EMPTY; }
@@ -243,6 +298,10 @@ struct Board
 
     int NumMoves() const { return m_state.m_history.NumMoves(); }
 
+    SgMove LastMove() const { return m_state.m_history.LastMove(); }
+
+    const History& GetHistory() const { return m_state.m_history; }
+
     //------------------------------------------------------------
 
     void Swap();
@@ -307,6 +366,13 @@ struct Board
                         MarkedCellsWithList& threatInter,
                         MarkedCellsWithList& threatUnion);
 
+    // Cells toPlay must play to stop the opponent's one-move VC wins:
+    // the intersection of the winning carriers (plus the winning
+    // cell) of all of them. Returns false if the opponent has no such
+    // win or toPlay may have one of its own; then every move counts.
+    // An empty mustplay means every move loses.
+    bool ComputeMustplay(SgBlackWhite toPlay, MarkedCells& mustplay);
+
 
     void MarkCellNotDirty(cell_t p);
     void MarkCellDirtyCon(cell_t p); 
@@ -463,6 +529,8 @@ private:
 
     ConstBoard m_constBrd;
 
+    Statistics* m_statistics;
+
     struct State 
     {
         boost::scoped_array<SgBoardColor> m_color;
@@ -497,6 +565,9 @@ private:
     State m_savePoint1;
     State m_savePoint2;
 
+    /** Position before the trial moves of ComputeMustplay(). */
+    State m_mustplayState;
+
     MarkedCellsWithList m_dirtyConCells;
     MarkedCellsWithList m_dirtyWeightCells;
     MarkedCellsWithList m_dirtyBlocks;
@@ -538,6 +609,8 @@ private:
 
     SgMove MaintainConnection(cell_t b1, cell_t b2) const;
 
+    int ConnectedBorder(cell_t p, SgBlackWhite color) const;
+
     cell_t BlockIndex(cell_t p) const
     { return m_state.m_blockIndex[p]; }
 
@@ -115,6 +115,25 @@ ConstBoard::ConstBoard(int size)
             m_cell_nbr[p][ DIR_W  ] = (c == 0) ? WEST : p - 1;
         }
     }
+
+    // A cell's distances to the west, east and south edges are
+    // (c, r-c, size-1-r); each symmetry permutes them, and the edges
+    // with them.
+    static const int perm[NUM_SYMMETRIES][3] = 
+        { {0,1,2}, {1,0,2}, {0,2,1}, {2,1,0}, {1,2,0}, {2,0,1} };
+    for (int s = 0; s < NUM_SYMMETRIES; ++s) {
+        m_symmetric[s].resize(TotalCells);
+        for (int e = 0; e < 3; ++e)
+            m_symmetric[s][perm[s][e]] = e;
+        for (int r = 0; r < Size(); r++) {
+            for (int c = 0; c <= r; c++) {
+                const int dist[3] = { c, r - c, Size() - 1 - r };
+                const int nr = Size() - 1 - dist[perm[s][2]];
+                const int nc = dist[perm[s][0]];
+                m_symmetric[s][fatten(r, c)] = fatten(nr, nc);
+            }
+        }
+    }
 }
 
 //---------------------------------------------------------------------------
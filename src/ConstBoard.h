@@ -80,6 +80,11 @@ struct MarkedCells
         m_marked &= ~other.m_marked;
     }
 
+    void Intersect(const MarkedCells& other)
+    {
+        m_marked &= other.m_marked;
+    }
+
     size_t Count() const
     {
         return m_marked.count(); 
@@ -210,6 +215,10 @@ public:
     static const int BORDER_SOUTH = 4; // 100
     static const int BORDER_ALL   = 7; // 111
 
+    /** Rotations and reflections of the triangle; 0 is the
+        identity. */
+    static const int NUM_SYMMETRIES = 6;
+
     static bool IsEdge(cell_t cell)
     {
         return (cell == WEST || cell == EAST || cell == SOUTH);
@@ -267,10 +276,15 @@ public:
     cell_t PointInDir(cell_t cell, int dir) const
     { return m_cell_nbr[cell][dir]; }
 
+    /** Image of a cell or edge under one of the symmetries. */
+    cell_t Symmetric(cell_t cell, int symmetry) const
+    { return m_symmetric[symmetry][cell]; }
+
 private:
     std::vector<cell_t> m_cells;
     std::vector<cell_t> m_cells_edges;
     std::vector<std::vector<cell_t> > m_cell_nbr;
+    std::vector<cell_t> m_symmetric[NUM_SYMMETRIES];
 
     friend class Board;
     friend class CellIterator;
@@ -0,0 +1,78 @@
+#include "LockstepPlayouts.h"
+
+//---------------------------------------------------------------------------
+
+LockstepPlayouts::LockstepPlayouts()
+{
+    SetNumLanes(16);
+}
+
+void LockstepPlayouts::SetNumLanes(int lanes)
+{
+    SG_ASSERT(lanes > 0 && lanes <= MAX_LANES);
+    m_numLanes = lanes;
+    m_allLanes = (lanes == MAX_LANES) ? ~Lanes(0) : (Lanes(1) << lanes) - 1;
+}
+
+float LockstepPlayouts::Run(const PlayoutBoard& brd, SgRandom& random)
+{
+    // Cells are numbered consecutively after the three edges.
+    const int first = ConstBoard::FIRST_NON_EDGE;
+    const int end = first + brd.Size() * (brd.Size() + 1) / 2;
+
+    const MarkedCells& black = brd.Stones(SG_BLACK);
+    for (int p = first; p < end; ++p)
+        m_black[p] = black.Marked(p) ? m_allLanes : 0;
+    for (int edge = 0; edge < first; ++edge)
+        m_black[edge] = 0;
+
+    // Give black a uniformly random subset of the empty cells in
+    // each lane with a partial Fisher-Yates shuffle.
+    const int numEmpty = brd.NumEmpty();
+    const int numBlack = (brd.ToPlay() == SG_BLACK) 
+        ? (numEmpty + 1) / 2 : numEmpty / 2;
+    for (int i = 0; i < numEmpty; ++i)
+        m_order[i] = brd.Empty(i);
+    for (int lane = 0; lane < m_numLanes; ++lane) 
+    {
+        const Lanes bit = Lanes(1) << lane;
+        for (int i = 0; i < numBlack; ++i) 
+        {
+            const int j = i + random.Int(numEmpty - i);
+            std::swap(m_order[i], m_order[j]);
+            m_black[m_order[i]] |= bit;
+        }
+    }
+
+    for (int edge = 0; edge < first; ++edge)
+        Flood(brd, edge, end);
+
+    Lanes blackWins = 0;
+    for (int p = first; p < end; ++p)
+        blackWins |= m_reach[0][p] & m_reach[1][p] & m_reach[2][p];
+    int count = 0;
+    for (; blackWins; blackWins &= blackWins - 1)
+        ++count;
+    return float(count) / float(m_numLanes);
+}
+
+void LockstepPlayouts::Flood(const PlayoutBoard& brd, int edge, int end)
+{
+    Lanes* reach = m_reach[edge];
+    for (int p = 0; p < end; ++p)
+        reach[p] = 0;
+    reach[edge] = m_allLanes;
+    // Alternate forward and backward sweeps until nothing changes;
+    // chains are usually covered after a couple of passes.
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int p = ConstBoard::FIRST_NON_EDGE; p < end; ++p)
+            changed |= Relax(brd, reach, p);
+        for (int p = end - 1; p >= ConstBoard::FIRST_NON_EDGE; --p)
+            changed |= Relax(brd, reach, p);
+    }
+}
+
+//---------------------------------------------------------------------------
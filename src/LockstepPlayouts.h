@@ -0,0 +1,72 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgRandom.h"
+
+#include "ConstBoard.h"
+#include "PlayoutBoard.h"
+
+//---------------------------------------------------------------------------
+
+/** Runs several uniformly random playouts from one position at once.
+
+    A Y game never needs to be played past a win: filling the rest of
+    the board cannot change the winner, and a full board always has
+    exactly one winner. A random playout is therefore equivalent to a
+    random split of the empty cells between the players, with the
+    player to move getting the extra cell if the count is odd.
+
+    The games are bit-sliced: every cell holds a word with one bit per
+    game (lane), and the winner of all lanes is found together by
+    flooding black stones from each edge with word-wide operations. 
+    A lane is won by black if some stone is reached from all three
+    edges. */
+class LockstepPlayouts
+{
+public:
+    typedef uint32_t Lanes;
+
+    static const int MAX_LANES = 32;
+
+    LockstepPlayouts();
+
+    int NumLanes() const { return m_numLanes; }
+
+    void SetNumLanes(int lanes);
+
+    /** Plays NumLanes() random games from brd and returns the
+        fraction won by black. */
+    float Run(const PlayoutBoard& brd, SgRandom& random);
+
+private:
+    int m_numLanes;
+
+    Lanes m_allLanes;
+
+    /** Lanes in which each cell holds a black stone. */
+    Lanes m_black[Y_MAX_CELL];
+
+    /** Lanes in which each cell is reached from each edge. */
+    Lanes m_reach[3][Y_MAX_CELL];
+
+    cell_t m_order[Y_MAX_CELL];
+
+    void Flood(const PlayoutBoard& brd, int edge, int end);
+
+    bool Relax(const PlayoutBoard& brd, Lanes* reach, cell_t p) const;
+};
+
+inline bool LockstepPlayouts::Relax(const PlayoutBoard& brd, Lanes* reach, 
+                                    cell_t p) const
+{
+    Lanes r = reach[p];
+    for (int dir = 0; dir < 6; ++dir)
+        r |= reach[brd.PointInDir(p, dir)];
+    r &= m_black[p];
+    if (r == reach[p])
+        return false;
+    reach[p] = r;
+    return true;
+}
+
+//---------------------------------------------------------------------------
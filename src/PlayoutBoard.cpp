@@ -0,0 +1,107 @@
+#include "PlayoutBoard.h"
+#include "Board.h"
+
+//---------------------------------------------------------------------------
+
+PlayoutBoard::PlayoutBoard()
+    : m_size(-1)
+    , m_toPlay(SG_BLACK)
+    , m_winner(SG_EMPTY)
+    , m_lastMove(SG_NULLMOVE)
+    , m_numEmpty(0)
+{
+}
+
+void PlayoutBoard::Init(const ConstBoard& cbrd)
+{
+    m_size = cbrd.Size();
+    for (CellIterator i(cbrd); i; ++i)
+        for (int dir = 0; dir < 6; ++dir)
+            m_nbr[*i][dir] = cbrd.PointInDir(*i, dir);
+}
+
+void PlayoutBoard::SetPosition(const Board& brd)
+{
+    if (m_size != brd.Size())
+        Init(brd.Const());
+    m_stones[SG_BLACK].Clear();
+    m_stones[SG_WHITE].Clear();
+    m_numEmpty = 0;
+    for (CellIterator i(brd.Const()); i; ++i) {
+        m_emptyIndex[*i] = m_numEmpty;
+        m_empty[m_numEmpty++] = *i;
+    }
+    m_winner = SG_EMPTY;
+    for (CellIterator i(brd.Const()); i; ++i)
+        if (brd.IsOccupied(*i))
+            AddStone(brd.GetColor(*i), *i);
+    m_toPlay = brd.ToPlay();
+    m_lastMove = brd.LastMove();
+}
+
+void PlayoutBoard::AddStone(SgBlackWhite color, cell_t p)
+{
+    m_stones[color].Mark(p);
+
+    const cell_t moved = m_empty[--m_numEmpty];
+    m_empty[m_emptyIndex[p]] = moved;
+    m_emptyIndex[moved] = m_emptyIndex[p];
+
+    // p becomes the root of the merged chain
+    m_parent[p] = p;
+    int border = 0;
+    for (int dir = 0; dir < 6; ++dir) {
+        const cell_t n = m_nbr[p][dir];
+        if (ConstBoard::IsEdge(n))
+            border |= ConstBoard::ToBorderValue(n);
+        else if (m_stones[color].Marked(n)) {
+            const cell_t root = Find(n);
+            if (root != p) {
+                m_parent[root] = p;
+                border |= m_border[root];
+            }
+        }
+    }
+    m_border[p] = border;
+    if (border == ConstBoard::BORDER_ALL && m_winner == SG_EMPTY)
+        m_winner = color;
+}
+
+cell_t PlayoutBoard::SaveBridge(SgRandom& random) const
+{
+    if (m_lastMove < ConstBoard::FIRST_NON_EDGE)
+        return SG_NULLMOVE;
+    // In clockwise order around the last move, match mine-empty-mine
+    // starting from a random direction.
+    const MarkedCells& mine = m_stones[m_toPlay];
+    int s = 0;
+    const int start = random.Int(6);
+    cell_t ret = SG_NULLMOVE;
+    for (int j = 0; j < 8; ++j)
+    {
+        const cell_t p = m_nbr[m_lastMove][(j + start) % 6];
+        const bool isMine = mine.Marked(p);
+        if (s == 0)
+        {
+            if (isMine) s = 1;
+        }
+        else if (s == 1)
+        {
+            if (isMine) s = 1;
+            else if (ConstBoard::IsEdge(p) || !IsEmpty(p)) s = 0;
+            else
+            {
+                s = 2;
+                ret = p;
+            }
+        }
+        else if (s == 2)
+        {
+            if (isMine) return ret; // matched!!
+            else s = 0;
+        }
+    }
+    return SG_NULLMOVE;
+}
+
+//---------------------------------------------------------------------------
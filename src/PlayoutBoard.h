@@ -0,0 +1,110 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgBoardColor.h"
+#include "SgMove.h"
+#include "SgRandom.h"
+
+#include "ConstBoard.h"
+
+class Board;
+
+//---------------------------------------------------------------------------
+
+/** Minimal board for playouts that need no connection knowledge.
+    Keeps one stone bitmask per color and a union-find over stones in
+    which each root stores the edges its chain touches; a chain
+    touching all three edges wins the game. Seeded from a Board at
+    the start of the playout phase. */
+class PlayoutBoard
+{
+public:
+    PlayoutBoard();
+
+    /** Copies the stones and the player to move from brd. */
+    void SetPosition(const Board& brd);
+
+    int Size() const { return m_size; }
+
+    SgBlackWhite ToPlay() const { return m_toPlay; }
+
+    bool IsGameOver() const { return m_winner != SG_EMPTY; }
+    SgBoardColor GetWinner() const { return m_winner; }
+    bool IsWinner(SgBlackWhite player) const { return m_winner == player; }
+
+    bool IsEmpty(cell_t p) const
+    { return !m_stones[SG_BLACK].Marked(p) && !m_stones[SG_WHITE].Marked(p); }
+
+    const MarkedCells& Stones(SgBlackWhite color) const 
+    { return m_stones[color]; }
+
+    int NumEmpty() const { return m_numEmpty; }
+
+    /** Returns the i'th empty cell, 0 <= i < NumEmpty(). */
+    cell_t Empty(int i) const { return m_empty[i]; }
+
+    cell_t LastMove() const { return m_lastMove; }
+
+    cell_t PointInDir(cell_t p, int dir) const { return m_nbr[p][dir]; }
+
+    /** Plays p for the player to move. p must be empty. */
+    void Play(cell_t p);
+
+    /** Returns a uniformly random empty cell. */
+    cell_t RandomEmpty(SgRandom& random) const
+    { return m_empty[random.Int(m_numEmpty)]; }
+
+    /** Returns the cell that restores a bridge of the player to move
+        that the last move intruded into, or SG_NULLMOVE. 
+        Same pattern as Board::SaveBridge(). */
+    cell_t SaveBridge(SgRandom& random) const;
+
+private:
+    int m_size;
+
+    SgBlackWhite m_toPlay;
+
+    SgBoardColor m_winner;
+
+    cell_t m_lastMove;
+
+    MarkedCells m_stones[2];
+
+    cell_t m_nbr[Y_MAX_CELL][6];
+
+    /** Union-find parent of each stone; roots point to themselves. */
+    cell_t m_parent[Y_MAX_CELL];
+
+    /** Edges touched by the chain; valid for roots only. */
+    int m_border[Y_MAX_CELL];
+
+    cell_t m_empty[Y_MAX_CELL];
+
+    int m_emptyIndex[Y_MAX_CELL];
+
+    int m_numEmpty;
+
+    void Init(const ConstBoard& cbrd);
+
+    void AddStone(SgBlackWhite color, cell_t p);
+
+    cell_t Find(cell_t p);
+};
+
+inline cell_t PlayoutBoard::Find(cell_t p)
+{
+    while (m_parent[p] != p) {
+        m_parent[p] = m_parent[m_parent[p]];
+        p = m_parent[p];
+    }
+    return p;
+}
+
+inline void PlayoutBoard::Play(cell_t p)
+{
+    AddStone(m_toPlay, p);
+    m_lastMove = p;
+    m_toPlay = SgOppBW(m_toPlay);
+}
+
+//---------------------------------------------------------------------------
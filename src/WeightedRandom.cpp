@@ -97,21 +97,25 @@ int WeightedRandom::Choose(SgRandom& random) const
 
 int WeightedRandom::ChooseLinear(SgRandom& random) const
 {
-    int i;
-    do {
-        const float rand = random.Float(m_weights[1]);
-        float r = rand;
-        for (i = m_size; i < 2 * m_size; ++i) 
-        {
-            r -= m_weights[i];
-            if (r <= 0.00009 && m_weights[i] > 0.0f)
-                return i - m_size;
-        }
-        // std::cerr() << "Didn't find it!\n"
-        //             << "total=" << m_weights[1] << " rand=" << rand 
-        //             << " r=" << r << '\n';
-    } while (1);
-    return i - m_size;
+    return ChooseLinear(random.Float(m_weights[1]));
+}
+
+int WeightedRandom::ChooseLinear(float random) const
+{
+    // Total is maintained incrementally by SetWeight() and can drift
+    // slightly from the sum of the leafs, so fall back to the last
+    // non-zero leaf if we walk off the end.
+    int last = -1;
+    for (int i = m_size; i < 2 * m_size; ++i) 
+    {
+        if (m_weights[i] <= 0.0f)
+            continue;
+        last = i;
+        random -= m_weights[i];
+        if (random <= 0.00009f)
+            return i - m_size;
+    }
+    return last < 0 ? -1 : last - m_size;
 }
 
 //----------------------------------------------------------------------------
@@ -49,6 +49,10 @@ public:
     /** Select a leaf. O(size). */
     int ChooseLinear(SgRandom& random) const;
 
+    /** Select the leaf at position random in [0, Total()); lets the
+        caller share a single draw with other distributions. O(size). */
+    int ChooseLinear(float random) const;
+
 private:
     int m_size;
     float* m_weights;
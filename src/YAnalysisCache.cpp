@@ -0,0 +1,206 @@
+#include "SgSystem.h"
+#include "SgUctTree.h"
+
+#include "YAnalysisCache.h"
+#include "Board.h"
+#include "YException.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+const uint32_t CACHE_MAGIC = 0x59414331; // "YAC1"
+
+bool MoreVisited(const YAnalysisCache::Child& a,
+                 const YAnalysisCache::Child& b)
+{
+    return a.m_count > b.m_count;
+}
+
+}
+
+//---------------------------------------------------------------------------
+
+YAnalysisCache::YAnalysisCache()
+    : m_map(0),
+      m_mapSize(0),
+      m_entries(0),
+      m_numSets(0)
+{
+}
+
+YAnalysisCache::~YAnalysisCache()
+{
+    Close();
+}
+
+void YAnalysisCache::Open(const std::string& filename, std::size_t numEntries)
+{
+    Close();
+    const int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        throw YException() << "Cannot open '" << filename << "': "
+                           << strerror(errno);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw YException() << "Cannot stat '" << filename << "'";
+    }
+    Header header;
+    const bool exists = st.st_size >= static_cast<off_t>(sizeof(header))
+        && pread(fd, &header, sizeof(header), 0) == sizeof(header)
+        && header.m_magic == CACHE_MAGIC
+        && header.m_entrySize == sizeof(Entry)
+        && header.m_numEntries >= WAYS
+        && st.st_size == static_cast<off_t>(sizeof(Header)
+                                  + header.m_numEntries * sizeof(Entry));
+    if (! exists)
+    {
+        header.m_magic = CACHE_MAGIC;
+        header.m_entrySize = sizeof(Entry);
+        header.m_numEntries = std::max<std::size_t>(numEntries / WAYS, 1)
+            * WAYS;
+    }
+    const std::size_t size
+        = sizeof(Header) + header.m_numEntries * sizeof(Entry);
+    // ftruncate zero-fills, which marks all entries as unused.
+    if (! exists && (ftruncate(fd, 0) != 0 || ftruncate(fd, size) != 0
+                     || pwrite(fd, &header, sizeof(header), 0)
+                        != sizeof(header)))
+    {
+        close(fd);
+        throw YException() << "Cannot initialize '" << filename << "'";
+    }
+    void* map = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        throw YException() << "Cannot map '" << filename << "': "
+                           << strerror(errno);
+    m_filename = filename;
+    m_map = map;
+    m_mapSize = size;
+    m_entries = reinterpret_cast<Entry*>(static_cast<char*>(map)
+                                         + sizeof(Header));
+    m_numSets = header.m_numEntries / WAYS;
+}
+
+void YAnalysisCache::Close()
+{
+    if (m_map == 0)
+        return;
+    munmap(m_map, m_mapSize);
+    m_map = 0;
+    m_mapSize = 0;
+    m_entries = 0;
+    m_numSets = 0;
+    m_filename.clear();
+}
+
+/** Takes the seeded count and value of the child out of its
+    statistics. */
+void YAnalysisCache::RemoveSeed(const Entry& seed, Child& child)
+{
+    for (int i = 0; i < seed.m_numChildren; ++i)
+        if (seed.m_children[i].m_move == child.m_move)
+        {
+            const float seedCount = SeedCount(seed.m_children[i]);
+            const float count = child.m_count - seedCount;
+            if (count > 0)
+                child.m_value = std::max(0.0f, std::min(1.0f,
+                    (child.m_value * child.m_count 
+                     - seed.m_children[i].m_value * seedCount) / count));
+            child.m_count = std::max(count, 0.0f);
+            return;
+        }
+}
+
+uint64_t YAnalysisCache::Key(const SgHashCode& hash, SgBlackWhite toPlay)
+{
+    const uint64_t key = (static_cast<uint64_t>(hash.Code2()) << 32)
+        | hash.Code1();
+    // Key 0 marks an unused entry.
+    return (toPlay == SG_WHITE ? ~key : key) | 1;
+}
+
+YAnalysisCache::Entry* YAnalysisCache::Set(uint64_t key) const
+{
+    return m_entries + (key >> 1) % m_numSets * WAYS;
+}
+
+const YAnalysisCache::Entry*
+YAnalysisCache::Lookup(const Board& brd, SgBlackWhite toPlay) const
+{
+    if (! IsOpen())
+        return 0;
+    const uint64_t key = Key(brd.Hash(), toPlay);
+    const Entry* set = Set(key);
+    for (int i = 0; i < WAYS; ++i)
+        if (set[i].m_key == key && set[i].m_size == brd.Size())
+            return &set[i];
+    return 0;
+}
+
+void YAnalysisCache::Store(const Board& brd, SgBlackWhite toPlay,
+                           const SgUctTree& tree, const Entry* seed)
+{
+    if (! IsOpen())
+        return;
+    std::vector<Child> children;
+    for (SgUctChildIterator it(tree, tree.Root()); it; ++it)
+    {
+        const SgUctNode& node = *it;
+        if (node.MoveCount() == 0)
+            continue;
+        Child child;
+        child.m_move = node.Move();
+        child.m_count = static_cast<float>(node.MoveCount());
+        child.m_value = static_cast<float>(node.Mean());
+        if (seed != 0)
+            RemoveSeed(*seed, child);
+        if (child.m_count > 0)
+            children.push_back(child);
+    }
+    if (children.empty())
+        return;
+    const std::size_t numChildren
+        = std::min<std::size_t>(children.size(), MAX_CHILDREN);
+    std::partial_sort(children.begin(), children.begin() + numChildren,
+                      children.end(), MoreVisited);
+    float count = 0;
+    for (std::size_t i = 0; i < children.size(); ++i)
+        count += children[i].m_count;
+
+    const uint64_t key = Key(brd.Hash(), toPlay);
+    Entry* set = Set(key);
+    Entry* entry = 0;
+    for (int i = 0; i < WAYS && entry == 0; ++i)
+        if (set[i].m_key == key && set[i].m_size == brd.Size())
+            entry = &set[i];
+    if (entry != 0 && entry->m_count > count)
+        return;
+    if (entry == 0)
+    {
+        entry = &set[0];
+        for (int i = 1; i < WAYS; ++i)
+            if (set[i].m_count < entry->m_count)
+                entry = &set[i];
+    }
+    entry->m_key = key;
+    entry->m_size = brd.Size();
+    entry->m_count = count;
+    entry->m_numChildren = static_cast<int32_t>(numChildren);
+    std::copy(children.begin(), children.begin() + numChildren,
+              entry->m_children);
+}
+
+//---------------------------------------------------------------------------
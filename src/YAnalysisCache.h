@@ -0,0 +1,121 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgBlackWhite.h"
+#include "SgHash.h"
+#include "SgMove.h"
+
+#include <algorithm>
+#include <string>
+#include <stdint.h>
+
+class Board;
+class SgUctTree;
+
+//---------------------------------------------------------------------------
+
+/** Root statistics of earlier searches, kept in a memory-mapped file
+    so that they survive the process.
+    Entries are keyed on Board::Hash() (which includes the board size)
+    and the player to move, and hold the most visited root moves of
+    the largest search seen for the position. The file has a fixed
+    number of entries in sets of WAYS; a new position replaces the
+    entry in its set with the fewest games, so the cache keeps the
+    positions that were analyzed the most. */
+class YAnalysisCache
+{
+public:
+    /** Root moves kept per position, most visited first. */
+    static const int MAX_CHILDREN = 16;
+
+    /** Entries per set. */
+    static const int WAYS = 4;
+
+    /** Largest count a cached child seeds a search with, so that an
+        old lead cannot decide a new search by itself. */
+    static const int MAX_SEED_COUNT = 1000;
+
+    struct Child
+    {
+        int32_t m_move;
+
+        float m_count;
+
+        /** Value for the player to move at the root. */
+        float m_value;
+    };
+
+    struct Entry
+    {
+        uint64_t m_key;
+
+        int32_t m_size;
+
+        int32_t m_numChildren;
+
+        /** Games of the search that produced this entry. */
+        float m_count;
+
+        Child m_children[MAX_CHILDREN];
+    };
+
+    YAnalysisCache();
+
+    ~YAnalysisCache();
+
+    /** Maps the given file, creating it with numEntries entries if it
+        does not exist. An existing file keeps its own size. Throws
+        YException on failure. */
+    void Open(const std::string& filename, std::size_t numEntries);
+
+    void Close();
+
+    bool IsOpen() const { return m_entries != 0; }
+
+    const std::string& FileName() const { return m_filename; }
+
+    /** Returns 0 if the position is not cached. */
+    const Entry* Lookup(const Board& brd, SgBlackWhite toPlay) const;
+
+    /** Stores the root children of a search of the position, unless
+        the cache has a larger search of it. If the search was seeded
+        with seed, the seeded games are taken out again, so that only
+        the games of this search are stored. */
+    void Store(const Board& brd, SgBlackWhite toPlay, const SgUctTree& tree,
+               const Entry* seed = 0);
+
+    /** Count a search is seeded with for child: its count, at most
+        MAX_SEED_COUNT. */
+    static float SeedCount(const Child& child)
+    {
+        return std::min(child.m_count, static_cast<float>(MAX_SEED_COUNT));
+    }
+
+private:
+    struct Header
+    {
+        uint32_t m_magic;
+
+        uint32_t m_entrySize;
+
+        uint64_t m_numEntries;
+    };
+
+    std::string m_filename;
+
+    void* m_map;
+
+    std::size_t m_mapSize;
+
+    Entry* m_entries;
+
+    std::size_t m_numSets;
+
+    static uint64_t Key(const SgHashCode& hash, SgBlackWhite toPlay);
+
+    static void RemoveSeed(const Entry& seed, Child& child);
+
+    Entry* Set(uint64_t key) const;
+};
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,102 @@
+#include "SgSystem.h"
+
+#include "YBook.h"
+#include "Board.h"
+#include "YException.h"
+
+#include <algorithm>
+#include <cstdio>
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+const uint32_t BOOK_MAGIC = 0x59424b31; // "YBK1"
+
+}
+
+//---------------------------------------------------------------------------
+
+YBook::YBook()
+{
+}
+
+void YBook::Clear()
+{
+    m_entries.clear();
+}
+
+uint64_t YBook::Key(const SgHashCode& hash, SgBlackWhite toPlay)
+{
+    const uint64_t key = (static_cast<uint64_t>(hash.Code2()) << 32)
+        | hash.Code1();
+    return toPlay == SG_WHITE ? ~key : key;
+}
+
+bool YBook::Lookup(const Board& brd, SgBlackWhite toPlay,
+                   SgMove& move, float& value) const
+{
+    Entry entry;
+    entry.m_key = Key(brd.Hash(), toPlay);
+    std::vector<Entry>::const_iterator it
+        = std::lower_bound(m_entries.begin(), m_entries.end(), entry);
+    if (it == m_entries.end() || it->m_key != entry.m_key)
+        return false;
+    move = it->m_move;
+    value = it->m_value;
+    return true;
+}
+
+void YBook::Add(const SgHashCode& hash, SgBlackWhite toPlay,
+                SgMove move, float value)
+{
+    Entry entry;
+    entry.m_key = Key(hash, toPlay);
+    entry.m_move = move;
+    entry.m_value = value;
+    std::vector<Entry>::iterator it
+        = std::lower_bound(m_entries.begin(), m_entries.end(), entry);
+    if (it != m_entries.end() && it->m_key == entry.m_key)
+        *it = entry;
+    else
+        m_entries.insert(it, entry);
+}
+
+void YBook::Load(const std::string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (f == 0)
+        throw YException() << "Cannot open book '" << filename << "'";
+    uint32_t magic = 0;
+    uint32_t count = 0;
+    bool ok = fread(&magic, sizeof(magic), 1, f) == 1
+        && magic == BOOK_MAGIC
+        && fread(&count, sizeof(count), 1, f) == 1;
+    std::vector<Entry> entries(ok ? count : 0);
+    for (uint32_t i = 0; ok && i < count; ++i)
+        ok = fread(&entries[i].m_key, sizeof(uint64_t), 1, f) == 1
+            && fread(&entries[i].m_move, sizeof(int32_t), 1, f) == 1
+            && fread(&entries[i].m_value, sizeof(float), 1, f) == 1;
+    fclose(f);
+    if (! ok)
+        throw YException() << "Invalid book '" << filename << "'";
+    m_entries.swap(entries);
+}
+
+void YBook::Save(const std::string& filename) const
+{
+    FILE* f = fopen(filename.c_str(), "wb");
+    if (f == 0)
+        throw YException() << "Cannot write book '" << filename << "'";
+    const uint32_t count = static_cast<uint32_t>(m_entries.size());
+    bool ok = fwrite(&BOOK_MAGIC, sizeof(BOOK_MAGIC), 1, f) == 1
+        && fwrite(&count, sizeof(count), 1, f) == 1;
+    for (std::size_t i = 0; ok && i < m_entries.size(); ++i)
+        ok = fwrite(&m_entries[i].m_key, sizeof(uint64_t), 1, f) == 1
+            && fwrite(&m_entries[i].m_move, sizeof(int32_t), 1, f) == 1
+            && fwrite(&m_entries[i].m_value, sizeof(float), 1, f) == 1;
+    if (fclose(f) != 0 || ! ok)
+        throw YException() << "Cannot write book '" << filename << "'";
+}
+
+//---------------------------------------------------------------------------
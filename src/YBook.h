@@ -0,0 +1,67 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgBlackWhite.h"
+#include "SgHash.h"
+#include "SgMove.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class Board;
+
+//---------------------------------------------------------------------------
+
+/** Opening book: the move to play and its value in a set of
+    positions. Positions are keyed on Board::Hash(), which includes the
+    board size, and the player to move, so one book covers all sizes.
+    On disk the book is a magic number, an entry count and the entries
+    sorted by key, in host byte order. */
+class YBook
+{
+public:
+    YBook();
+
+    void Clear();
+
+    bool IsEmpty() const { return m_entries.empty(); }
+
+    std::size_t Size() const { return m_entries.size(); }
+
+    /** Replaces the book with the contents of a file. Throws
+        YException if the file cannot be read. */
+    void Load(const std::string& filename);
+
+    /** Throws YException if the file cannot be written. */
+    void Save(const std::string& filename) const;
+
+    /** Returns false if the position is not in the book. The value is
+        for the player to move. */
+    bool Lookup(const Board& brd, SgBlackWhite toPlay,
+                SgMove& move, float& value) const;
+
+    /** Adds or replaces the entry of a position. */
+    void Add(const SgHashCode& hash, SgBlackWhite toPlay,
+             SgMove move, float value);
+
+private:
+    struct Entry
+    {
+        uint64_t m_key;
+
+        int32_t m_move;
+
+        float m_value;
+
+        bool operator<(const Entry& other) const
+        { return m_key < other.m_key; }
+    };
+
+    /** Sorted by key. */
+    std::vector<Entry> m_entries;
+
+    static uint64_t Key(const SgHashCode& hash, SgBlackWhite toPlay);
+};
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,289 @@
+#include "SgSystem.h"
+
+#include "YDfpnSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+/** Sum of proof numbers; a sum of finite numbers stays finite. */
+uint32_t AddProof(uint32_t a, uint32_t b)
+{
+    if (a >= YDfpnSolver::INFTY || b >= YDfpnSolver::INFTY)
+        return YDfpnSolver::INFTY;
+    return static_cast<uint32_t>(std::min<uint64_t>(
+        static_cast<uint64_t>(a) + b, YDfpnSolver::INFTY - 1));
+}
+
+}
+
+//---------------------------------------------------------------------------
+
+YDfpnTable::YDfpnTable(int bits)
+    : m_locks(new boost::mutex[NUM_LOCKS])
+{
+    Resize(bits);
+}
+
+void YDfpnTable::Resize(int bits)
+{
+    std::vector<Entry>(std::size_t(1) << bits).swap(m_entries);
+    m_mask = (std::size_t(1) << bits) - 1;
+    Clear();
+}
+
+void YDfpnTable::Clear()
+{
+    Entry empty;
+    empty.m_key = 0;
+    empty.m_phi = 1;
+    empty.m_delta = 1;
+    empty.m_work = 0;
+    empty.m_bestMove = SG_NULLMOVE;
+    std::fill(m_entries.begin(), m_entries.end(), empty);
+}
+
+uint64_t YDfpnTable::Key(const SgHashCode& hash, SgBlackWhite toPlay)
+{
+    const uint64_t key = (static_cast<uint64_t>(hash.Code2()) << 32)
+        | hash.Code1();
+    return toPlay == SG_WHITE ? ~key : key;
+}
+
+bool YDfpnTable::Lookup(uint64_t key, Entry& entry) const
+{
+    const std::size_t index = key & m_mask;
+    boost::mutex::scoped_lock lock(Lock(index));
+    const Entry& e = m_entries[index];
+    if (e.m_key != key || e.m_work == 0)
+        return false;
+    entry = e;
+    return true;
+}
+
+void YDfpnTable::Store(const Entry& entry)
+{
+    const std::size_t index = entry.m_key & m_mask;
+    boost::mutex::scoped_lock lock(Lock(index));
+    Entry& e = m_entries[index];
+    if (e.m_key == entry.m_key || entry.m_work >= e.m_work)
+        e = entry;
+}
+
+//---------------------------------------------------------------------------
+
+YDfpnSolver::YDfpnSolver()
+    : m_epsilon(0.25),
+      m_tableBits(20),
+      m_ownTable(new YDfpnTable(m_tableBits)),
+      m_table(m_ownTable.get()),
+      m_abortFlag(0),
+      m_endgameDb(0),
+      m_brd(8),
+      m_maxTime(0),
+      m_maxNodes(std::numeric_limits<std::size_t>::max()),
+      m_aborted(false),
+      m_numNodes(0),
+      m_maxDepth(0)
+{
+}
+
+YDfpnSolver::YDfpnSolver(YDfpnTable& table)
+    : m_epsilon(0.25),
+      m_tableBits(0),
+      m_table(&table),
+      m_abortFlag(0),
+      m_endgameDb(0),
+      m_brd(8),
+      m_maxTime(0),
+      m_maxNodes(std::numeric_limits<std::size_t>::max()),
+      m_aborted(false),
+      m_numNodes(0),
+      m_maxDepth(0)
+{
+}
+
+void YDfpnSolver::SetTableBits(int bits)
+{
+    SG_ASSERT(m_ownTable);
+    if (bits == m_tableBits)
+        return;
+    m_ownTable->Resize(bits);
+    m_tableBits = bits;
+}
+
+void YDfpnSolver::ClearTable()
+{
+    m_table->Clear();
+}
+
+SgBoardColor YDfpnSolver::Solve(const Board& brd, SgBlackWhite toPlay,
+                                double maxTime, SgMove& move)
+{
+    m_brd.SetPosition(brd);
+    m_maxTime = maxTime;
+    m_aborted = false;
+    m_numNodes = 0;
+    m_maxDepth = 0;
+    m_children.resize(Y_MAX_CELL + 1);
+    m_timer.Start();
+    YDfpnTable::Entry root;
+    MID(toPlay, YDfpnTable::Key(m_brd.Hash(), toPlay), INFTY, INFTY, 0,
+        root);
+    move = SG_NULLMOVE;
+    if (root.m_phi == 0)
+    {
+        move = root.m_bestMove;
+        return toPlay;
+    }
+    if (root.m_delta == 0)
+        return SgOppBW(toPlay);
+    return SG_EMPTY;
+}
+
+bool YDfpnSolver::CheckAbort()
+{
+    if (! m_aborted
+        && (m_numNodes >= m_maxNodes
+            || (m_numNodes % CHECK_INTERVAL == 0
+                && (SgUserAbort() || m_timer.GetTime() > m_maxTime
+                    || (m_abortFlag != 0 && *m_abortFlag)))))
+        m_aborted = true;
+    return m_aborted;
+}
+
+/** Children sorted by weight, so that ties between proof numbers go
+    to the move the board knowledge prefers. Only moves in the
+    mustplay are generated, so there are none if every move loses. */
+void YDfpnSolver::GenerateChildren(SgBlackWhite toPlay,
+                                   std::vector<Child>& children)
+{
+    children.clear();
+    Board::SymmetryList symmetries;
+    m_brd.GetSymmetries(symmetries);
+    MarkedCells mustplay;
+    const bool restricted = m_brd.ComputeMustplay(toPlay, mustplay);
+    for (Board::EmptyIterator it(m_brd); it; ++it)
+        if ((! restricted || mustplay.Marked(*it))
+            && m_brd.IsSymmetryRepresentative(*it, symmetries, 
+                                             restricted ? &mustplay : 0))
+        {
+            Child child;
+            child.m_move = *it;
+            child.m_key = YDfpnTable::Key(m_brd.HashAfterMove(*it, toPlay),
+                                          SgOppBW(toPlay));
+            child.m_weight = m_brd.WeightCell(*it);
+            LookupChild(child);
+            children.push_back(child);
+        }
+    std::stable_sort(children.begin(), children.end());
+}
+
+void YDfpnSolver::LookupChild(Child& child) const
+{
+    YDfpnTable::Entry entry;
+    if (m_table->Lookup(child.m_key, entry))
+    {
+        child.m_phi = entry.m_phi;
+        child.m_delta = entry.m_delta;
+    }
+    else
+    {
+        child.m_phi = 1;
+        child.m_delta = 1;
+    }
+}
+
+/** Multiple iterative deepening: searches below the current position
+    until its phi reaches thPhi or its delta reaches thDelta. The
+    phi of a position is the smallest delta of its children, its
+    delta the sum of their phis. */
+void YDfpnSolver::MID(SgBlackWhite toPlay, uint64_t key, uint32_t thPhi,
+                      uint32_t thDelta, int ply, YDfpnTable::Entry& result)
+{
+    ++m_numNodes;
+    m_maxDepth = std::max(m_maxDepth, ply);
+    result.m_key = key;
+    result.m_bestMove = SG_NULLMOVE;
+    SgBoardColor winner = SG_EMPTY;
+    if (m_brd.HasWinningVC())
+        winner = m_brd.GetVCWinner();
+    else if (m_brd.IsGameOver())
+        winner = m_brd.GetWinner();
+    else if (m_endgameDb != 0 && ply > 0)
+        winner = m_endgameDb->Lookup(m_brd, toPlay);
+    if (winner != SG_EMPTY)
+    {
+        result.m_phi = (winner == toPlay) ? 0 : INFTY;
+        result.m_delta = (winner == toPlay) ? INFTY : 0;
+        result.m_work = 1;
+        m_table->Store(result);
+        return;
+    }
+    std::vector<Child>& children = m_children[ply];
+    GenerateChildren(toPlay, children);
+    if (children.empty())
+    {
+        result.m_phi = INFTY;
+        result.m_delta = 0;
+        result.m_work = 1;
+        m_table->Store(result);
+        return;
+    }
+    const std::size_t startNodes = m_numNodes;
+    for (;;)
+    {
+        uint32_t phi = INFTY;
+        uint32_t delta = 0;
+        uint32_t delta2 = INFTY;
+        uint32_t bestPhi = INFTY;
+        std::size_t best = 0;
+        for (std::size_t i = 0; i < children.size(); ++i)
+        {
+            const uint32_t childPhi = children[i].m_phi;
+            const uint32_t childDelta = children[i].m_delta;
+            if (childDelta < phi)
+            {
+                delta2 = phi;
+                phi = childDelta;
+                bestPhi = childPhi;
+                best = i;
+            }
+            else if (childDelta < delta2)
+                delta2 = childDelta;
+            delta = AddProof(delta, childPhi);
+        }
+        result.m_phi = phi;
+        result.m_delta = delta;
+        result.m_bestMove = children[best].m_move;
+        if (phi >= thPhi || delta >= thDelta || CheckAbort())
+            break;
+        const uint32_t childThPhi = (thDelta >= INFTY) ? INFTY
+            : thDelta - (delta - bestPhi);
+        uint32_t childThDelta = thPhi;
+        if (delta2 < INFTY)
+        {
+            const double widened = std::ceil(delta2 * (1.0 + m_epsilon));
+            childThDelta = std::min<uint32_t>(thPhi,
+                static_cast<uint32_t>(std::min<double>(
+                    std::max<double>(widened, delta2 + 1.0), INFTY)));
+        }
+        const SgMove move = children[best].m_move;
+        YDfpnTable::Entry childResult;
+        m_brd.Play(toPlay, static_cast<cell_t>(move));
+        MID(SgOppBW(toPlay), children[best].m_key, childThPhi,
+            childThDelta, ply + 1, childResult);
+        m_brd.Undo();
+        children[best].m_phi = childResult.m_phi;
+        children[best].m_delta = childResult.m_delta;
+    }
+    result.m_work = static_cast<uint32_t>(std::min<std::size_t>(
+        m_numNodes - startNodes + 1, INFTY));
+    m_table->Store(result);
+}
+
+//---------------------------------------------------------------------------
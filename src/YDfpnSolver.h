@@ -0,0 +1,196 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgBlackWhite.h"
+#include "SgHash.h"
+#include "SgMove.h"
+#include "SgTimer.h"
+
+#include "Board.h"
+#include "YEndgameDb.h"
+
+#include <vector>
+#include <stdint.h>
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+//---------------------------------------------------------------------------
+
+/** Proof and disproof numbers of positions, shared by all searches of
+    a YDfpnSolver. Numbers are from the point of view of the player to
+    move: phi is the proof number of a win for that player, delta the
+    proof number of a loss. Entries are replaced if the new one took
+    at least as much work, so that expensive results stay.
+    The table can be shared by solvers in several threads: entries
+    are guarded by a fixed set of locks, chosen by index. */
+class YDfpnTable
+{
+public:
+    struct Entry
+    {
+        uint64_t m_key;
+
+        uint32_t m_phi;
+
+        uint32_t m_delta;
+
+        /** Nodes searched below this position for these numbers. */
+        uint32_t m_work;
+
+        /** Best child for the player to move. */
+        int32_t m_bestMove;
+    };
+
+    explicit YDfpnTable(int bits);
+
+    void Clear();
+
+    /** Changes the size to 2^bits entries and clears the table. */
+    void Resize(int bits);
+
+    std::size_t Size() const { return m_entries.size(); }
+
+    static uint64_t Key(const SgHashCode& hash, SgBlackWhite toPlay);
+
+    /** Returns false if the position is not in the table. */
+    bool Lookup(uint64_t key, Entry& entry) const;
+
+    void Store(const Entry& entry);
+
+private:
+    static const std::size_t NUM_LOCKS = 1024;
+
+    std::vector<Entry> m_entries;
+
+    std::size_t m_mask;
+
+    boost::scoped_array<boost::mutex> m_locks;
+
+    boost::mutex& Lock(std::size_t index) const
+    { return m_locks[index & (NUM_LOCKS - 1)]; }
+};
+
+//---------------------------------------------------------------------------
+
+/** Depth-first proof-number search (df-pn) with the 1+epsilon trick.
+    Terminal positions are recognized by the board's VC detection: a
+    position is won as soon as either player has a winning virtual
+    connection. Y has no draws and positions never repeat, so the
+    search graph is acyclic and no cycle handling is needed. */
+class YDfpnSolver
+{
+public:
+    /** Proof and disproof numbers are capped below INFTY. */
+    static const uint32_t INFTY = 0x7fffffff;
+
+    YDfpnSolver();
+
+    /** Solver that uses table instead of a table of its own, e.g. one
+        shared with solvers in other threads. */
+    explicit YDfpnSolver(YDfpnTable& table);
+
+    /** Child thresholds are 1+epsilon times the second best
+        number; larger values switch between siblings less often. */
+    double Epsilon() const    { return m_epsilon; }
+    void SetEpsilon(double e) { m_epsilon = e; }
+
+    /** Table size is 2^bits entries. Clears the table. Only for
+        solvers with their own table. */
+    int TableBits() const { return m_tableBits; }
+    void SetTableBits(int bits);
+
+    /** Solves brd with toPlay to move, within maxTime seconds (or
+        until SgUserAbort()). Returns the winner, or SG_EMPTY if the
+        search did not finish; if toPlay wins, move is a winning
+        move. The table is kept between calls. */
+    SgBoardColor Solve(const Board& brd, SgBlackWhite toPlay, double maxTime,
+                       SgMove& move);
+
+    /** Solve() stops after about this many positions. */
+    std::size_t MaxNodes() const       { return m_maxNodes; }
+    void SetMaxNodes(std::size_t nodes) { m_maxNodes = nodes; }
+
+    /** Positions expanded by the last Solve(). */
+    std::size_t NumNodes() const { return m_numNodes; }
+
+    /** Deepest ply reached by the last Solve(). */
+    int MaxDepth() const { return m_maxDepth; }
+
+    void ClearTable();
+
+    YDfpnTable& Table() { return *m_table; }
+
+    /** Solve() also stops when *flag becomes true. 0 for none. */
+    void SetAbortFlag(const volatile bool* flag) { m_abortFlag = flag; }
+
+    /** Positions in the database are terminal, except the root, which
+        is expanded so that a win comes with a winning move. 0 for
+        none. */
+    void SetEndgameDb(const YEndgameDb* db) { m_endgameDb = db; }
+
+private:
+    /** Nodes between two checks of the time limit. */
+    static const std::size_t CHECK_INTERVAL = 1024;
+
+    struct Child
+    {
+        SgMove m_move;
+
+        uint64_t m_key;
+
+        float m_weight;
+
+        /** Numbers of the child position, from the table when the
+            node was generated and from the searches of the child
+            since; kept here so that they survive replacement in the
+            table. */
+        uint32_t m_phi;
+
+        uint32_t m_delta;
+
+        bool operator<(const Child& other) const
+        { return m_weight > other.m_weight; }
+    };
+
+    double m_epsilon;
+
+    int m_tableBits;
+
+    boost::scoped_ptr<YDfpnTable> m_ownTable;
+
+    YDfpnTable* m_table;
+
+    const volatile bool* m_abortFlag;
+
+    const YEndgameDb* m_endgameDb;
+
+    Board m_brd;
+
+    SgTimer m_timer;
+
+    double m_maxTime;
+
+    std::size_t m_maxNodes;
+
+    bool m_aborted;
+
+    std::size_t m_numNodes;
+
+    int m_maxDepth;
+
+    /** Children of the nodes on the current line, by ply; kept to
+        avoid allocating in every node. */
+    std::vector<std::vector<Child> > m_children;
+
+    void MID(SgBlackWhite toPlay, uint64_t key, uint32_t thPhi,
+             uint32_t thDelta, int ply, YDfpnTable::Entry& result);
+
+    bool CheckAbort();
+
+    void GenerateChildren(SgBlackWhite toPlay, std::vector<Child>& children);
+
+    void LookupChild(Child& child) const;
+};
+
+//---------------------------------------------------------------------------
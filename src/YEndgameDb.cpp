@@ -0,0 +1,379 @@
+#include "SgSystem.h"
+#include "SgDebug.h"
+
+#include "YEndgameDb.h"
+#include "Board.h"
+#include "YException.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+const uint32_t DB_MAGIC = 0x59454731; // "YEG1"
+
+const int MAX_CELLS = YEndgameDb::MAX_SIZE * (YEndgameDb::MAX_SIZE + 1) / 2;
+
+int NumBits(uint32_t x)
+{
+    int n = 0;
+    for (; x != 0; x &= x - 1)
+        ++n;
+    return n;
+}
+
+/** Next larger mask with the same number of bits (Gosper's hack);
+    masks come in the order of their combinatorial rank. */
+uint32_t NextSubset(uint32_t x)
+{
+    const uint32_t c = x & (~x + 1);
+    const uint32_t r = x + c;
+    return (((r ^ x) >> 2) / c) | r;
+}
+
+/** Spreads the low bits of bits over the set bits of mask. */
+uint32_t Deposit(uint32_t bits, uint32_t mask)
+{
+    uint32_t result = 0;
+    for (uint32_t b = 1; mask != 0; b <<= 1)
+    {
+        const uint32_t lowest = mask & (~mask + 1);
+        if (bits & b)
+            result |= lowest;
+        mask ^= lowest;
+    }
+    return result;
+}
+
+bool TestBit(const unsigned char* bits, uint64_t index)
+{
+    return (bits[index >> 3] >> (index & 7)) & 1;
+}
+
+}
+
+//---------------------------------------------------------------------------
+
+/** Cells of one board size as bits 0..m_numCells-1, and the indexing
+    of its positions. */
+struct YEndgameDb::Layout
+{
+    int m_numCells;
+
+    uint64_t m_binomial[MAX_CELLS + 1][MAX_CELLS + 1];
+
+    /** Index of the first position with n stones; the last entry is
+        the number of positions. */
+    uint64_t m_layerOffset[MAX_CELLS + 2];
+
+    uint32_t m_neighbors[MAX_CELLS];
+
+    int m_border[MAX_CELLS];
+
+    explicit Layout(int size);
+
+    uint64_t NumPositions() const { return m_layerOffset[m_numCells + 1]; }
+
+    /** White must have half the stones, rounded down. */
+    uint64_t Index(uint32_t black, uint32_t white) const;
+
+    bool HasChain(uint32_t stones) const;
+};
+
+YEndgameDb::Layout::Layout(int size)
+{
+    const ConstBoard cbrd(size);
+    m_numCells = size * (size + 1) / 2;
+    SG_ASSERT(m_numCells <= MAX_CELLS);
+    for (int n = 0; n <= MAX_CELLS; ++n)
+        for (int k = 0; k <= MAX_CELLS; ++k)
+            m_binomial[n][k] = (k == 0) ? 1 : (n == 0) ? 0
+                : m_binomial[n - 1][k - 1] + m_binomial[n - 1][k];
+    m_layerOffset[0] = 0;
+    for (int n = 0; n <= m_numCells; ++n)
+        m_layerOffset[n + 1] = m_layerOffset[n]
+            + m_binomial[m_numCells][n] * m_binomial[n][n / 2];
+    for (CellIterator it(cbrd); it; ++it)
+    {
+        const int i = *it - ConstBoard::FIRST_NON_EDGE;
+        m_neighbors[i] = 0;
+        m_border[i] = ConstBoard::BORDER_NONE;
+        for (CellNbrIterator nb(cbrd, *it); nb; ++nb)
+        {
+            const int j = *nb - ConstBoard::FIRST_NON_EDGE;
+            if (ConstBoard::IsEdge(*nb))
+                m_border[i] |= ConstBoard::ToBorderValue(*nb);
+            else if (j >= 0 && j < m_numCells)
+                m_neighbors[i] |= uint32_t(1) << j;
+        }
+    }
+}
+
+uint64_t YEndgameDb::Layout::Index(uint32_t black, uint32_t white) const
+{
+    const uint32_t occupied = black | white;
+    uint64_t occupiedRank = 0;
+    uint64_t whiteRank = 0;
+    int k = 0;
+    int j = 0;
+    for (int i = 0; i < m_numCells; ++i)
+        if (occupied & (uint32_t(1) << i))
+        {
+            occupiedRank += m_binomial[i][++k];
+            if (white & (uint32_t(1) << i))
+                whiteRank += m_binomial[k - 1][++j];
+        }
+    return m_layerOffset[k] + occupiedRank * m_binomial[k][k / 2] + whiteRank;
+}
+
+/** Whether some chain of stones touches all three edges. */
+bool YEndgameDb::Layout::HasChain(uint32_t stones) const
+{
+    uint32_t left = stones;
+    while (left != 0)
+    {
+        uint32_t chain = left & (~left + 1);
+        uint32_t frontier = chain;
+        int border = ConstBoard::BORDER_NONE;
+        while (frontier != 0)
+        {
+            uint32_t next = 0;
+            for (uint32_t f = frontier; f != 0; f &= f - 1)
+            {
+                int i = 0;
+                while (! (f & (uint32_t(1) << i)))
+                    ++i;
+                border |= m_border[i];
+                next |= m_neighbors[i];
+            }
+            frontier = next & stones & ~chain;
+            chain |= frontier;
+        }
+        if (border == ConstBoard::BORDER_ALL)
+            return true;
+        left &= ~chain;
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------
+
+YEndgameDb::YEndgameDb()
+    : m_map(0),
+      m_mapSize(0)
+{
+    std::fill(m_bits, m_bits + MAX_SIZE + 1,
+              static_cast<const unsigned char*>(0));
+}
+
+YEndgameDb::~YEndgameDb()
+{
+    Close();
+}
+
+/** Retrograde analysis: a position is won for the player to move if
+    the opponent has no chain and either the player has one or some
+    move leads to a position lost for the opponent. Positions with
+    more stones come first, so the children are always known. */
+void YEndgameDb::Build(const std::vector<int>& sizes,
+                       const std::string& filename)
+{
+    std::vector<std::vector<unsigned char> > tables;
+    std::vector<TableInfo> infos;
+    uint64_t offset = sizeof(Header) + sizes.size() * sizeof(TableInfo);
+    for (std::size_t s = 0; s < sizes.size(); ++s)
+    {
+        const int size = sizes[s];
+        if (size < 1 || size > MAX_SIZE)
+            throw YException() << "Endgame database size must be 1.."
+                               << MAX_SIZE;
+        const Layout layout(size);
+        const int numCells = layout.m_numCells;
+        const uint32_t all = (uint32_t(1) << numCells) - 1;
+        tables.push_back(std::vector<unsigned char>(
+                             (layout.NumPositions() + 7) / 8, 0));
+        unsigned char* bits = &tables.back()[0];
+        for (int n = numCells; n >= 0; --n)
+        {
+            const bool blackToPlay = (n % 2 == 0);
+            const int numWhite = n / 2;
+            uint64_t index = layout.m_layerOffset[n];
+            for (uint32_t occupied = (uint32_t(1) << n) - 1;
+                 occupied <= all; occupied = NextSubset(occupied))
+            {
+                for (uint32_t w = (uint32_t(1) << numWhite) - 1;
+                     w < (uint32_t(1) << n); w = NextSubset(w))
+                {
+                    const uint32_t white = Deposit(w, occupied);
+                    const uint32_t black = occupied ^ white;
+                    const uint32_t toPlay = blackToPlay ? black : white;
+                    bool win = false;
+                    if (! layout.HasChain(occupied ^ toPlay))
+                    {
+                        win = layout.HasChain(toPlay);
+                        for (uint32_t e = all & ~occupied; e != 0 && ! win;
+                             e &= e - 1)
+                        {
+                            const uint32_t p = e & (~e + 1);
+                            const uint64_t child = blackToPlay
+                                ? layout.Index(black | p, white)
+                                : layout.Index(black, white | p);
+                            win = ! TestBit(bits, child);
+                        }
+                    }
+                    SG_ASSERT(index == layout.Index(black, white));
+                    if (win)
+                        bits[index >> 3] |= 1 << (index & 7);
+                    ++index;
+                    if (numWhite == 0)
+                        break;
+                }
+                if (n == 0)
+                    break;
+            }
+        }
+        SgDebug() << "Endgame database: size " << size << ", "
+                  << layout.NumPositions() << " positions, first player "
+                  << (TestBit(bits, 0) ? "wins" : "loses") << '\n';
+        TableInfo info;
+        info.m_size = size;
+        info.m_unused = 0;
+        info.m_offset = offset;
+        info.m_numPositions = layout.NumPositions();
+        infos.push_back(info);
+        offset += (tables.back().size() + 7) / 8 * 8;
+    }
+
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if (! out)
+        throw YException() << "Cannot write '" << filename << "'";
+    Header header;
+    header.m_magic = DB_MAGIC;
+    header.m_numTables = static_cast<uint32_t>(sizes.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (std::size_t i = 0; i < infos.size(); ++i)
+        out.write(reinterpret_cast<const char*>(&infos[i]), sizeof(infos[i]));
+    for (std::size_t i = 0; i < tables.size(); ++i)
+    {
+        const std::size_t padding = (tables[i].size() + 7) / 8 * 8
+            - tables[i].size();
+        out.write(reinterpret_cast<const char*>(&tables[i][0]),
+                  tables[i].size());
+        out.write("\0\0\0\0\0\0\0", padding);
+    }
+    if (! out)
+        throw YException() << "Error writing '" << filename << "'";
+}
+
+void YEndgameDb::Open(const std::string& filename)
+{
+    Close();
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw YException() << "Cannot open '" << filename << "': "
+                           << strerror(errno);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw YException() << "Cannot stat '" << filename << "'";
+    }
+    const std::size_t size = st.st_size;
+    void* map = (size > 0)
+        ? mmap(0, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED)
+        throw YException() << "Cannot map '" << filename << "'";
+    m_map = map;
+    m_mapSize = size;
+    const char* base = static_cast<const char*>(map);
+    const Header* header = reinterpret_cast<const Header*>(base);
+    if (size < sizeof(Header) || header->m_magic != DB_MAGIC
+        || size < sizeof(Header) + header->m_numTables * sizeof(TableInfo))
+    {
+        Close();
+        throw YException() << "'" << filename
+                           << "' is not an endgame database";
+    }
+    const TableInfo* infos
+        = reinterpret_cast<const TableInfo*>(base + sizeof(Header));
+    for (uint32_t i = 0; i < header->m_numTables; ++i)
+    {
+        const TableInfo& info = infos[i];
+        if (info.m_size < 1 || info.m_size > MAX_SIZE)
+            continue;
+        m_layouts[info.m_size].reset(new Layout(info.m_size));
+        if (info.m_numPositions != m_layouts[info.m_size]->NumPositions()
+            || info.m_offset + (info.m_numPositions + 7) / 8 > size)
+        {
+            Close();
+            throw YException() << "Bad table for size " << info.m_size
+                               << " in '" << filename << "'";
+        }
+        m_bits[info.m_size]
+            = reinterpret_cast<const unsigned char*>(base + info.m_offset);
+    }
+    m_filename = filename;
+}
+
+void YEndgameDb::Close()
+{
+    if (m_map == 0)
+        return;
+    munmap(m_map, m_mapSize);
+    m_map = 0;
+    m_mapSize = 0;
+    for (int i = 0; i <= MAX_SIZE; ++i)
+    {
+        m_bits[i] = 0;
+        m_layouts[i].reset();
+    }
+    m_filename.clear();
+}
+
+bool YEndgameDb::HasSize(int size) const
+{
+    return size >= 1 && size <= MAX_SIZE && m_bits[size] != 0;
+}
+
+SgBoardColor YEndgameDb::Lookup(const Board& brd, SgBlackWhite toPlay) const
+{
+    if (! HasSize(brd.Size()))
+        return SG_EMPTY;
+    uint32_t black = 0;
+    uint32_t white = 0;
+    for (CellIterator it(brd); it; ++it)
+    {
+        const uint32_t bit
+            = uint32_t(1) << (*it - ConstBoard::FIRST_NON_EDGE);
+        if (brd.GetColor(*it) == SG_BLACK)
+            black |= bit;
+        else if (brd.GetColor(*it) == SG_WHITE)
+            white |= bit;
+    }
+    const int numBlack = NumBits(black);
+    const int numWhite = NumBits(white);
+    bool exchange;
+    if (numBlack == numWhite)
+        exchange = (toPlay == SG_WHITE);
+    else if (numBlack == numWhite + 1 && toPlay == SG_WHITE)
+        exchange = false;
+    else if (numWhite == numBlack + 1 && toPlay == SG_BLACK)
+        exchange = true;
+    else
+        return SG_EMPTY;
+    if (exchange)
+        std::swap(black, white);
+    const uint64_t index = m_layouts[brd.Size()]->Index(black, white);
+    return TestBit(m_bits[brd.Size()], index) ? toPlay : SgOppBW(toPlay);
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgBlackWhite.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/scoped_ptr.hpp>
+
+class Board;
+
+//---------------------------------------------------------------------------
+
+/** Winners of all positions of the small board sizes, kept in a
+    memory-mapped file.
+    A size's table has one bit per position with as many white stones
+    as black stones, or one less: set if the player to move wins. The
+    index of a position is a perfect hash: positions are ordered by
+    number of stones, then by the set of occupied cells, then by which
+    of them are white, and ranked in the combinatorial number system.
+    Y has no color-specific edges, so positions with the other color
+    to move are looked up with the colors exchanged.
+    Tables are built by retrograde analysis, from the full board back
+    to the empty one; size 6 has 2.2*10^9 positions (260MB) and takes
+    hours to build. */
+class YEndgameDb
+{
+public:
+    /** Largest size that fits the 32-bit cell masks. */
+    static const int MAX_SIZE = 6;
+
+    YEndgameDb();
+
+    ~YEndgameDb();
+
+    /** Solves every position of the given sizes and writes the tables
+        to filename. Throws YException on failure. */
+    static void Build(const std::vector<int>& sizes,
+                      const std::string& filename);
+
+    /** Maps a file written by Build(). Throws YException on
+        failure. */
+    void Open(const std::string& filename);
+
+    void Close();
+
+    bool IsOpen() const { return m_map != 0; }
+
+    const std::string& FileName() const { return m_filename; }
+
+    bool HasSize(int size) const;
+
+    /** Winner of brd with toPlay to move, or SG_EMPTY if the position
+        is not in the database. */
+    SgBoardColor Lookup(const Board& brd, SgBlackWhite toPlay) const;
+
+private:
+    struct Layout;
+
+    struct Header
+    {
+        uint32_t m_magic;
+
+        uint32_t m_numTables;
+    };
+
+    struct TableInfo
+    {
+        int32_t m_size;
+
+        uint32_t m_unused;
+
+        /** From the start of the file. */
+        uint64_t m_offset;
+
+        uint64_t m_numPositions;
+    };
+
+    std::string m_filename;
+
+    void* m_map;
+
+    std::size_t m_mapSize;
+
+    const unsigned char* m_bits[MAX_SIZE + 1];
+
+    boost::scoped_ptr<Layout> m_layouts[MAX_SIZE + 1];
+};
+
+//---------------------------------------------------------------------------
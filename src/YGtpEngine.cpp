@@ -2,7 +2,11 @@
 /** @file YGtpEngine.cpp */
 //----------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <sstream>
 
 #include "SgSystem.h"
 #include "SgDebug.h"
@@ -12,9 +16,55 @@
 #include "SgTimer.h"
 #include "SgGameReader.h"
 #include "SgGameWriter.h"
+#include "SgUctTreeUtil.h"
+
+#include <boost/thread/thread.hpp>
 
 #include "YGtpEngine.h"
+#include "YPositionReader.h"
 #include "YSgUtil.h"
+#include "YUctSearchUtil.h"
+
+//----------------------------------------------------------------------------
+
+namespace {
+
+void AddRootStatistics(const SgUctTree& tree, RootStatistics& stats)
+{
+    for (SgUctChildIterator it(tree, tree.Root()); it; ++it)
+        if ((*it).MoveCount() > 0)
+            stats.Add((*it).Move(), (*it).MoveCount(), (*it).Mean());
+}
+
+bool MoreVisited(const SgUctNode* a, const SgUctNode* b)
+{
+    return a->MoveCount() > b->MoveCount();
+}
+
+std::string JsonString(const std::string& s)
+{
+    std::ostringstream os;
+    os << '"';
+    for (std::size_t i = 0; i < s.size(); ++i)
+    {
+        const unsigned char c = s[i];
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (c < 0x20)
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+               << static_cast<int>(c) << std::dec << std::setfill(' ');
+        else
+            os << c;
+    }
+    os << '"';
+    return os.str();
+}
+
+}
+
+//----------------------------------------------------------------------------
+
+const double YGtpEngine::ROOT_PARALLEL_ROUND = 1.0;
 
 //----------------------------------------------------------------------------
 
@@ -22,8 +72,13 @@ YGtpEngine::YGtpEngine(int boardSize)
     : GtpEngine(),
       m_brd(boardSize),
       m_search(),
+      m_solver("dfpn"),
+      m_solverThreads(0),
       m_hashTable(16000000), // 64MB
       m_uctSearch(new YUctThreadStateFactory()),
+      m_useBook(true),
+      m_analysisCachePlayCount(0),
+      m_hasRootSeed(false),
       m_uctMaxGames(99999999),
       m_uctMaxTime(10.0),
       m_playerName("uct"),
@@ -31,7 +86,13 @@ YGtpEngine::YGtpEngine(int boardSize)
       m_timeLeft(0),
       m_timeSettingsSpecified(false),
       m_ignoreClock(false),
-      m_allowSwap(true)
+      m_allowSwap(true),
+      m_reuseSubtree(true),
+      m_searchSize(-1),
+      m_searchToPlay(SG_BLACK),
+      m_ponder(false),
+      m_ponderPending(false),
+      m_rootWorker(false)
 {
     RegisterCmd("exec", &YGtpEngine::CmdExec);
     RegisterCmd("name", &YGtpEngine::CmdName);
@@ -67,6 +128,13 @@ YGtpEngine::YGtpEngine(int boardSize)
     RegisterCmd("playout_move", &YGtpEngine::CmdPlayoutMove);
     RegisterCmd("playout_weights", &YGtpEngine::CmdPlayoutWeights);
     RegisterCmd("playout_statistics", &YGtpEngine::CmdPlayoutStatistics);
+    RegisterCmd("uct_scaling", &YGtpEngine::CmdUctScaling);
+    RegisterCmd("uct_root_search", &YGtpEngine::CmdUctRootSearch);
+    RegisterCmd("book_expand", &YGtpEngine::CmdBookExpand);
+    RegisterCmd("endgame_db_build", &YGtpEngine::CmdEndgameDbBuild);
+    RegisterCmd("uct_tree_dump", &YGtpEngine::CmdUctTreeDump);
+    RegisterCmd("uct_tree_load", &YGtpEngine::CmdUctTreeLoad);
+    RegisterCmd("uct_tree_sgf", &YGtpEngine::CmdUctTreeSgf);
 
     RegisterCmd("board_statistics", &YGtpEngine::CmdBoardStatistics);
     
@@ -94,6 +162,11 @@ YGtpEngine::YGtpEngine(int boardSize)
     RegisterCmd("group_value", &YGtpEngine::CmdGroupValue);
     RegisterCmd("group_carrier", &YGtpEngine::CmdGroupCarrier);
 
+    m_search.SetEndgameDb(&m_endgameDb);
+    m_dfpn.SetEndgameDb(&m_endgameDb);
+    m_parallelSolver.SetEndgameDb(&m_endgameDb);
+    m_uctSearch.SetEndgameDb(&m_endgameDb);
+
     NewGame();
 }
 
@@ -136,6 +209,7 @@ void YGtpEngine::CmdAnalyzeCommands(GtpCommand& cmd)
 	"string/Group Blocks/group_blocks %p\n"
         "plist/Group Carrier/group_carrier %p\n"
         "string/Playout Statistics/playout_statistics\n"
+        "string/UCT Scaling/uct_scaling\n"
         "pspairs/Playout Weights/playout_weights\n"
         "move/Playout Move/playout_move\n";
 }
@@ -175,18 +249,21 @@ void YGtpEngine::ApplyTimeSettings()
 
 void YGtpEngine::NewGame(int size)
 {
+    m_ponderPending = false;
     m_brd.SetSize(size);
     ApplyTimeSettings();
 }
 
 void YGtpEngine::NewGame()
 {
+    m_ponderPending = false;
     m_brd.SetSize(m_brd.Size());
     ApplyTimeSettings();
 }
 
 void YGtpEngine::Play(int color, int move)
 {
+    m_ponderPending = false;
     if (move == Y_SWAP) {
         if (!m_allowSwap)
             throw GtpFailure("Swap setting is disabled!");
@@ -207,6 +284,7 @@ void YGtpEngine::Play(int color, int move)
 void YGtpEngine::Undo()
 {
     SG_ASSERT(m_brd.NumMoves() > 0);
+    m_ponderPending = false;
     m_brd.Undo();
 }
 
@@ -232,8 +310,33 @@ int YGtpEngine::GenMove(bool useGameClock, SgBlackWhite toPlay)
             return car[SgRandom::Global().Int(car.size())];
         }
 
-        m_brd.SetToPlay(toPlay);        
-        m_uctSearch.SetPosition(m_brd);
+        SgMove bookMove;
+        float bookValue;
+        // The empty board entry assumes the opponent may swap.
+        if (m_useBook && (m_brd.NumMoves() > 0 || m_allowSwap)
+            && m_book.Lookup(m_brd, toPlay, bookMove, bookValue))
+        {
+            SgDebug() << "Book move " << m_brd.ToString(bookMove)
+                      << " value=" << bookValue << '\n';
+            if (m_allowSwap && m_brd.NumMoves() == 1 && bookValue < 0.5)
+                return Y_SWAP;
+            return bookMove;
+        }
+
+        const YAnalysisCache::Entry* cached 
+            = m_analysisCache.Lookup(m_brd, toPlay);
+        if (cached != 0 && m_analysisCachePlayCount > 0
+            && cached->m_count >= m_analysisCachePlayCount)
+        {
+            const YAnalysisCache::Child& best = cached->m_children[0];
+            SgDebug() << "Cached move " << m_brd.ToString(best.m_move)
+                      << " value=" << best.m_value 
+                      << " count=" << cached->m_count << '\n';
+            if (m_allowSwap && m_brd.NumMoves() == 1 && best.m_value < 0.5)
+                return Y_SWAP;
+            return best.m_move;
+        }
+
         std::vector<SgMove> sequence;
         double maxTime = m_uctMaxTime;
         std::size_t maxGames = m_uctMaxGames;
@@ -243,7 +346,7 @@ int YGtpEngine::GenMove(bool useGameClock, SgBlackWhite toPlay)
             SgDebug() << "timeLeft=" << timeLeft << ' ';
             if (timeLeft > 0)
             {
-                maxTime = timeLeft / 10.0;
+                maxTime = TimeForMove(timeLeft);
                 maxGames = 99999999;
             }
             else
@@ -252,7 +355,11 @@ int YGtpEngine::GenMove(bool useGameClock, SgBlackWhite toPlay)
         if (maxTime < 0.5)
             maxTime = 0.5;
         SgDebug() << "maxTime=" << maxTime << " maxGames=" << maxGames << '\n';
-        float score = m_uctSearch.Search(maxGames, maxTime, sequence);
+        float score;
+        if (m_rootParallel.NumWorkers() > 0)
+            score = RootParallelSearch(toPlay, maxGames, maxTime, sequence);
+        else
+            score = UctSearch(toPlay, maxGames, maxTime, sequence);
         m_uctSearch.WriteStatistics(std::cerr);
         std::cerr << "Score          " << std::setprecision(2) << score << '\n';
         for (std::size_t i = 0; i < sequence.size(); i++) 
@@ -261,6 +368,8 @@ int YGtpEngine::GenMove(bool useGameClock, SgBlackWhite toPlay)
 	
         if (m_allowSwap && m_brd.NumMoves()==1 && score < 0.5)
             return Y_SWAP;
+        if (sequence.empty())
+            return SolvedRootMove(toPlay, maxTime);
         return sequence[0];
     }
     else if (m_playerName == "random")
@@ -277,6 +386,253 @@ int YGtpEngine::GenMove(bool useGameClock, SgBlackWhite toPlay)
     return SG_RESIGN;
 }
 
+/** Move for a root that the search left without children: the
+    winning move of df-pn if toPlay wins, else the first empty cell,
+    since then every move loses. */
+SgMove YGtpEngine::SolvedRootMove(SgBlackWhite toPlay, double maxTime)
+{
+    SgMove move = SG_NULLMOVE;
+    const SgBoardColor winner = m_dfpn.Solve(m_brd, toPlay, maxTime, move);
+    if (winner == toPlay && move != SG_NULLMOVE)
+    {
+        SgDebug() << "Search found no move, solver wins with "
+                  << m_brd.ToString(move) << '\n';
+        return move;
+    }
+    SgDebug() << "Search found no move, playing any cell\n";
+    return *Board::EmptyIterator(m_brd);
+}
+
+/** Splits the remaining time evenly over the moves we still expect
+    to play. Games rarely fill the board, so we assume about half of
+    the empty cells get played, half of them by us. Time saved by
+    the search's early stop carries over to later moves. */
+double YGtpEngine::TimeForMove(double timeLeft) const
+{
+    int numEmpty = 0;
+    for (Board::EmptyIterator it(m_brd); it; ++it)
+        ++numEmpty;
+    const int movesLeft = std::max(MIN_MOVES_LEFT, numEmpty / 4);
+    return timeLeft / movesLeft;
+}
+
+/** Searches in rounds of ROOT_PARALLEL_ROUND seconds. In each round
+    the workers and this process search the same position; their root
+    statistics are then added up. An early stop of the local search
+    ends the search and interrupts the workers; the early stop judges
+    the lead of the best move against the time left for the whole
+    search, not for the round. The move with the largest total count
+    is returned in sequence; the result is its total mean. If no move
+    has statistics, sequence is empty and the result is the value of
+    the last local search. */
+SgUctValue YGtpEngine::RootParallelSearch(SgBlackWhite toPlay, 
+                                          std::size_t maxGames,
+                                          double maxTime, 
+                                          std::vector<SgMove>& sequence)
+{
+    m_rootParallel.SetPosition(m_brd);
+    RootStatistics stats;
+    SgUctValue localScore = 0.5;
+    SgTimer timer;
+    for (;;)
+    {
+        const double left = maxTime - timer.GetTime();
+        const double round = std::min(left, ROOT_PARALLEL_ROUND);
+        m_rootParallel.StartSearch(toPlay, round);
+        std::vector<SgMove> localSequence;
+        localScore = UctSearch(toPlay, maxGames, round, localSequence,
+                               0, left);
+        const bool stop = m_uctSearch.StopReason() != "limit" 
+            || SgUserAbort();
+        if (stop)
+            m_rootParallel.Interrupt();
+        stats.Clear();
+        AddRootStatistics(m_uctSearch.Tree(), stats);
+        m_rootParallel.Collect(stats);
+        if (stop || left - round < 0.05)
+            break;
+    }
+    SgDebug() << "Root parallel:" << stats.ToString(m_brd.Const()) << '\n';
+    sequence.clear();
+    const SgMove best = stats.BestMove();
+    if (best == SG_NULLMOVE)
+        return localScore;
+    sequence.push_back(best);
+    return stats.Mean(best);
+}
+
+/** Searches the current position with toPlay to move, seeding the
+    search with initTree if given, else with the subtree of the
+    previous search if possible, or else with the analysis cache. The
+    root statistics of the search are stored in the analysis cache,
+    without the games the root was seeded with; a reused tree of the
+    same position still holds them.
+    If the search is one round of a longer one, moveTime is the time
+    left for all of it, which the early stop uses to decide whether
+    the best move can still change. */
+SgUctValue YGtpEngine::UctSearch(SgBlackWhite toPlay, std::size_t maxGames,
+                                 double maxTime, std::vector<SgMove>& sequence,
+                                 SgUctTree* initTree, double moveTime)
+{
+    m_brd.SetToPlay(toPlay);        
+    m_uctSearch.SetPosition(m_brd);
+    std::vector<SgMove> rootFilter;
+    bool reusedRoot = false;
+    if (initTree == 0 && m_reuseSubtree)
+    {
+        SgUctTree& tree = m_uctSearch.GetTempTree();
+        if (FindInitTree(tree, toPlay, maxTime))
+        {
+            initTree = &tree;
+            reusedRoot = HasTreeOfPosition();
+            SgDebug() << "Reusing " << tree.NuNodes() << " nodes\n";
+        }
+        else
+            SgDebug() << "No subtree to reuse\n";
+    }
+    if (initTree == 0)
+    {
+        const YAnalysisCache::Entry* cached 
+            = m_analysisCache.Lookup(m_brd, toPlay);
+        m_hasRootSeed = (cached != 0);
+        if (m_hasRootSeed)
+            m_rootSeed = *cached;
+    }
+    else if (! reusedRoot)
+        m_hasRootSeed = false;
+    const YAnalysisCache::Entry* seed = m_hasRootSeed ? &m_rootSeed : 0;
+    if (initTree == 0)
+        m_uctSearch.SetRootSeed(seed);
+    m_uctSearch.SetSearchLimits(maxGames, std::max(maxTime, moveTime));
+    SgUctValue score = m_uctSearch.Search(maxGames, maxTime, sequence,
+                                          rootFilter, initTree);
+    m_uctSearch.SetRootSeed(0);
+    m_analysisCache.Store(m_brd, toPlay, m_uctSearch.Tree(), seed);
+    m_searchHistory = m_brd.GetHistory();
+    m_searchSize = m_brd.Size();
+    m_searchToPlay = toPlay;
+    return score;
+}
+
+/** True if the tree of the last search is of the current position. */
+bool YGtpEngine::HasTreeOfPosition() const
+{
+    const Board::History& now = m_brd.GetHistory();
+    const Board::History& then = m_searchHistory;
+    if (m_searchSize != m_brd.Size() || now.NumMoves() != then.NumMoves())
+        return false;
+    for (int i = 0; i < then.NumMoves(); ++i)
+        if (   now.m_move[i] != then.m_move[i] 
+            || now.m_color[i] != then.m_color[i])
+            return false;
+    return true;
+}
+
+/** Copies the subtree of the last search that matches the current
+    position into initTree. Fails if the current position does not
+    follow from the searched one by alternating moves that are all
+    in the tree, or if the matching node is proven or has no children:
+    the leaf solver proves nodes without expanding them, and a proven
+    root would leave the search no move to choose. */
+bool YGtpEngine::FindInitTree(SgUctTree& initTree, SgBlackWhite toPlay,
+                              double maxTime) const
+{
+    const Board::History& now = m_brd.GetHistory();
+    const Board::History& then = m_searchHistory;
+    if (m_searchSize != m_brd.Size() || now.NumMoves() < then.NumMoves())
+        return false;
+    for (int i = 0; i < then.NumMoves(); ++i)
+        if (   now.m_move[i] != then.m_move[i] 
+            || now.m_color[i] != then.m_color[i])
+            return false;
+    const SgUctTree& tree = m_uctSearch.Tree();
+    const SgUctNode* node = &tree.Root();
+    SgBlackWhite color = m_searchToPlay;
+    for (int i = then.NumMoves(); i < now.NumMoves(); ++i)
+    {
+        if (now.m_color[i] != color)
+            return false;
+        node = SgUctTreeUtil::FindChildWithMove(tree, *node, now.m_move[i]);
+        if (node == 0)
+            return false;
+        color = SgOppBW(color);
+    }
+    if (color != toPlay || node->IsProven() || ! node->HasChildren())
+        return false;
+    tree.ExtractSubtree(initTree, *node, true, maxTime);
+    return true;
+}
+
+/** Searches each position of the input with the budget of max_games
+    and max_time and writes one JSON object per line to out: the best
+    move and its win rate for the player to move, the number of games,
+    and the numChildren most visited root moves. Finished positions
+    get the winner instead, and unreadable ones an error. Every
+    position gets the full budget, without early stop, so that the
+    win rates are comparable.
+    The search threads are kept between positions, the next positions
+    are set up by a YPositionReader while the current one is searched,
+    and consecutive positions of one game reuse the subtree of the
+    previous search. */
+void YGtpEngine::AnalyzeBatch(std::istream& in, std::ostream& out,
+                              std::size_t numChildren)
+{
+    const bool oldEarlyStop = m_uctSearch.EarlyStop();
+    m_uctSearch.SetEarlyStop(false);
+    YPositionReader reader(in);
+    YPositionReader::Position position;
+    while (reader.Next(position))
+    {
+        std::ostringstream os;
+        os << "{\"position\":" << JsonString(position.m_name);
+        if (! position.m_error.empty())
+        {
+            os << ",\"error\":" << JsonString(position.m_error) << "}\n";
+            out << os.str() << std::flush;
+            continue;
+        }
+        m_ponderPending = false;
+        m_brd.SetPosition(*position.m_brd);
+        const SgBlackWhite toPlay = m_brd.ToPlay();
+        os << ",\"size\":" << m_brd.Size() << ",\"to_play\":\""
+           << ConstBoard::ColorToChar(toPlay) << '"';
+        if (m_brd.HasWinningVC() || m_brd.IsGameOver())
+        {
+            const SgBoardColor winner = m_brd.HasWinningVC() 
+                ? m_brd.GetVCWinner() : m_brd.GetWinner();
+            os << ",\"winner\":\"" << ConstBoard::ColorToChar(winner) 
+               << "\"}\n";
+            out << os.str() << std::flush;
+            continue;
+        }
+        std::vector<SgMove> sequence;
+        const SgUctValue value 
+            = UctSearch(toPlay, m_uctMaxGames, m_uctMaxTime, sequence);
+        const SgUctTree& tree = m_uctSearch.Tree();
+        std::vector<const SgUctNode*> children;
+        for (SgUctChildIterator it(tree, tree.Root()); it; ++it)
+            if ((*it).MoveCount() > 0)
+                children.push_back(&(*it));
+        std::stable_sort(children.begin(), children.end(), MoreVisited);
+        if (children.size() > numChildren)
+            children.resize(numChildren);
+        os << ",\"move\":\"" 
+           << (sequence.empty() ? "none" : m_brd.ToString(sequence[0]))
+           << "\",\"winrate\":" << std::fixed << std::setprecision(4) 
+           << value << ",\"games\":" << std::setprecision(0)
+           << tree.Root().MoveCount() << ",\"children\":[";
+        for (std::size_t i = 0; i < children.size(); ++i)
+            os << (i > 0 ? "," : "") << "{\"move\":\"" 
+               << m_brd.ToString(children[i]->Move()) << "\",\"visits\":"
+               << std::setprecision(0) << children[i]->MoveCount()
+               << ",\"winrate\":" << std::setprecision(4)
+               << children[i]->Mean() << '}';
+        os << "]}\n";
+        out << os.str() << std::flush;
+    }
+    m_uctSearch.SetEarlyStop(oldEarlyStop);
+}
+
 #if GTPENGINE_INTERRUPT
 
 void YGtpEngine::Interrupt()
@@ -286,9 +642,50 @@ void YGtpEngine::Interrupt()
 
 #endif // GTPENGINE_INTERRUPT
 
+#if GTPENGINE_PONDER
+
+void YGtpEngine::InitPonder()
+{
+    SgSetUserAbort(false);
+}
+
+/** Runs until StopPonder() is called or the search stops by itself,
+    e.g. because the tree reached max_nodes; the early stop is off,
+    since the opponent's time is free. The resulting tree is
+    picked up by the next genmove through FindInitTree(). */
+void YGtpEngine::Ponder()
+{
+    if (!m_ponder || !m_ponderPending || m_playerName != "uct")
+        return;
+    if (m_brd.IsGameOver() || m_brd.HasWinningVC())
+        return;
+    m_ponderPending = false;
+    SgDebug() << "YGtpEngine::Ponder: start\n";
+    const bool oldEarlyStop = m_uctSearch.EarlyStop();
+    m_uctSearch.SetEarlyStop(false);
+    std::vector<SgMove> sequence;
+    UctSearch(m_brd.ToPlay(), m_uctMaxGames, 
+              std::numeric_limits<double>::max(), sequence);
+    m_uctSearch.SetEarlyStop(oldEarlyStop);
+    SgDebug() << "YGtpEngine::Ponder: end\n";
+}
+
+void YGtpEngine::StopPonder()
+{
+    SgSetUserAbort(true);
+}
+
+#endif // GTPENGINE_PONDER
+
 
 //----------------------------------------------------------------------------
 
+void YGtpEngine::ExecuteConfig(const std::string& filename)
+{
+    m_rootParallel.SetConfigFile(filename);
+    ExecuteFile(filename);
+}
+
 void YGtpEngine::CmdExec(GtpCommand& cmd)
 {
     cmd.CheckNuArg(1);
@@ -392,6 +789,7 @@ void YGtpEngine::CmdGenMove(GtpCommand& cmd)
         if (m_timeSettingsSpecified && !m_ignoreClock)
             m_timeLeft[color] -= timer.GetTime();
         Play(color, move);
+        m_ponderPending = true;
         if (move == Y_SWAP)
             cmd << "swap";
         else
@@ -410,12 +808,17 @@ std::string PrintPV(const SgVector<SgMove>& pv, const Board& brd)
     return os.str();
 }
 
-/** Solves the current position with iterative deepening.
-    Usage: "havannah_solve [timelimit] [max depth] [doTrace]"
+/** Solves the current position with the solver selected by y_param
+    solver: iterative deepening alpha-beta (YSearch) or df-pn
+    (YDfpnSolver).
+    Usage: "y_solve color [timelimit] [max depth] [doTrace]"
+    Prints the winner, the winning move, the depth reached and the
+    number of nodes searched.
 
     Timelimit: max time in seconds for the search.
-    Max depth: maximum depth to search to.
-    doTrace: whether to perform a search trace (default is off).
+    Max depth: maximum depth to search to (alpha-beta only).
+    doTrace: whether to perform a search trace (default is off;
+    alpha-beta only).
 */
 void YGtpEngine::CmdSolve(GtpCommand& cmd)
 {
@@ -423,19 +826,23 @@ void YGtpEngine::CmdSolve(GtpCommand& cmd)
     if (cmd.NuArg() < 1)
         throw GtpFailure("Must give color to play");
     SgBlackWhite toPlay = ColorArg(cmd, 0);
-    boost::scoped_ptr<SgTimeSearchControl> timeControl;
+    double timelimit = 0.0;
     if (cmd.NuArg() >= 2)
+        timelimit = cmd.Arg<float>(1);
+    if (m_solver == "dfpn")
     {
-        double timelimit = cmd.Arg<float>(0);
-        if (timelimit > 0.0)
-            timeControl.reset(new SgTimeSearchControl(timelimit));
+        SolveDfpn(cmd, toPlay, timelimit);
+        return;
     }
+    boost::scoped_ptr<SgTimeSearchControl> timeControl;
+    if (timelimit > 0.0)
+        timeControl.reset(new SgTimeSearchControl(timelimit));
     int maxDepth = m_brd.Const().TotalCells; //m_brd.Const().NumCells();
     if (cmd.NuArg() >= 3)
-        maxDepth = cmd.ArgMin<int>(1, 0);
+        maxDepth = cmd.ArgMin<int>(2, 0);
     bool doTrace = false;
     if (cmd.NuArg() == 4)
-        doTrace = cmd.Arg<bool>(2);
+        doTrace = cmd.Arg<bool>(3);
     SgVector<SgMove> pv;
     m_search.SetPosition(m_brd);
     m_search.SetToPlay(toPlay);
@@ -491,22 +898,118 @@ void YGtpEngine::CmdSolve(GtpCommand& cmd)
     cmd << ' ' << depth << ' ' << nodes;
 }
 
+/** Solves the current position with df-pn, for y_solve. Uses
+    YParallelSolver if y_param solver_threads (or num_threads, if it
+    is 0) is more than one. */
+void YGtpEngine::SolveDfpn(GtpCommand& cmd, SgBlackWhite toPlay, 
+                           double timelimit)
+{
+    const double maxTime = (timelimit > 0.0) 
+        ? timelimit : std::numeric_limits<double>::max();
+    const std::size_t numThreads = (m_solverThreads > 0)
+        ? m_solverThreads : m_uctSearch.NumberThreads();
+    SgTimer timer;
+    SgMove move;
+    SgBoardColor winner;
+    int depth;
+    std::size_t nodes;
+    if (numThreads > 1)
+    {
+        m_parallelSolver.SetNumThreads(numThreads);
+        m_parallelSolver.SetEpsilon(m_dfpn.Epsilon());
+        winner = m_parallelSolver.Solve(m_brd, toPlay, maxTime, 
+                                        m_dfpn.Table(), move);
+        depth = m_parallelSolver.MaxDepth();
+        nodes = m_parallelSolver.NumNodes();
+    }
+    else
+    {
+        winner = m_dfpn.Solve(m_brd, toPlay, maxTime, move);
+        depth = m_dfpn.MaxDepth();
+        nodes = m_dfpn.NumNodes();
+    }
+    SgDebug() << "df-pn: " << nodes << " nodes in "
+              << std::setprecision(2) << timer.GetTime() << "s, "
+              << numThreads << " threads\n";
+    if (winner == SG_EMPTY)
+        cmd << "unknown none";
+    else if (winner == toPlay)
+        cmd << (toPlay == SG_BLACK ? "black" : "white") << ' ' 
+            << (move == SG_NULLMOVE ? "none" : m_brd.ToString(move));
+    else
+        cmd << (toPlay == SG_BLACK ? "white" : "black") << ' ' << "none";
+    cmd << ' ' << depth << ' ' << nodes;
+}
+
 void YGtpEngine::CmdParam(GtpCommand& cmd)
 {
     if (cmd.NuArg() == 0)
     {
         cmd << '\n'
+            << "[bool] adaptive_expand_threshold " 
+            << m_uctSearch.AdaptiveExpandThreshold() << '\n'
             << "[bool] allow_swap " << m_allowSwap << '\n'
+            << "[bool] early_stop " << m_uctSearch.EarlyStop() << '\n'
             << "[bool] ignore_clock " << m_ignoreClock << '\n'
+            << "[bool] lock_free " << m_uctSearch.LockFree() << '\n'
+            << "[bool] ponder " << m_ponder << '\n'
+            << "[bool] progress_stream " 
+            << m_uctSearch.ProgressStream() << '\n'
+            << "[bool] prune_full_tree " 
+            << m_uctSearch.PruneFullTree() << '\n'
+            << "[bool] reuse_subtree " << m_reuseSubtree << '\n'
+            << "[bool] solver_move_ordering " 
+            << m_search.MoveOrdering() << '\n'
             << "[bool] use_livegfx " << m_uctSearch.LiveGfx() << '\n'
+            << "[bool] use_mustplay " << m_uctSearch.UseMustplay() << '\n'
             << "[bool] use_rave " << m_uctSearch.Rave() << '\n'
+            << "[bool] use_book " << m_useBook << '\n'
             << "[bool] use_savebridge " << m_uctSearch.UseSaveBridge() << '\n'
+            << "[bool] use_symmetry_pruning " 
+            << m_uctSearch.UseSymmetryPruning() << '\n'
+            << "[bool] use_transpositions " 
+            << m_uctSearch.UseTranspositions() << '\n'
+            << "[bool] use_vc_termination " 
+            << m_uctSearch.UseVCTermination() << '\n'
+            << "[bool] virtual_loss " << m_uctSearch.VirtualLoss() << '\n'
+            << "[string] analysis_cache " 
+            << m_analysisCache.FileName() << '\n'
+            << "[string] analysis_cache_play_count " 
+            << m_analysisCachePlayCount << '\n'
             << "[string] bias_term_constant " 
             << m_uctSearch.BiasTermConstant() << '\n'
+            << "[string] book_file " << m_bookFile << '\n'
+            << "[string] dfpn_epsilon " << m_dfpn.Epsilon() << '\n'
+            << "[string] dfpn_table_bits " << m_dfpn.TableBits() << '\n'
+            << "[string] endgame_db " << m_endgameDb.FileName() << '\n'
+            << "[string] early_stop_win_rate " 
+            << m_uctSearch.EarlyStopWinRate() << '\n'
             << "[string] expand_threshold " 
             << m_uctSearch.ExpandThreshold() << '\n'
+            << "[string] leaf_solve_empty " 
+            << m_uctSearch.LeafSolveEmpty() << '\n'
+            << "[string] leaf_solve_mustplay " 
+            << m_uctSearch.LeafSolveMustplay() << '\n'
+            << "[string] leaf_solve_nodes " 
+            << m_uctSearch.LeafSolveNodes() << '\n'
+            << "[string] light_playout_after " 
+            << m_uctSearch.LightPlayoutAfter() << '\n'
+            << "[string] lockstep_lanes " 
+            << m_uctSearch.LockstepLanes() << '\n'
             << "[string] number_playouts " 
             << m_uctSearch.NumberPlayouts() << '\n'
+            << "[string] prior_count " 
+            << m_uctSearch.PriorCount() << '\n'
+            << "[string] progressive_bias " 
+            << m_uctSearch.ProgressiveBias() << '\n'
+            << "[string] prune_min_count " 
+            << m_uctSearch.PruneMinCount() << '\n'
+            << "[string] report_interval " 
+            << m_uctSearch.ReportInterval() << '\n'
+            << "[list/alphabeta/dfpn] solver " << m_solver << '\n'
+            << "[string] solver_threads " << m_solverThreads << '\n'
+            << "[string] root_workers " 
+            << m_rootParallel.NumWorkers() << '\n'
             << "[string] num_threads " << m_uctSearch.NumberThreads() << '\n'
             << "[string] max_games " << m_uctMaxGames << '\n'
             << "[string] max_memory "
@@ -522,18 +1025,121 @@ void YGtpEngine::CmdParam(GtpCommand& cmd)
             m_uctSearch.SetRave(cmd.Arg<bool>(1));
         else if (name == "use_livegfx")
             m_uctSearch.SetLiveGfx(cmd.Arg<bool>(1));
+        else if (name == "progress_stream")
+            m_uctSearch.SetProgressStream(cmd.Arg<bool>(1));
+        else if (name == "report_interval")
+            m_uctSearch.SetReportInterval(cmd.ArgMin<double>(1, 0.01));
         else if (name == "use_savebridge")
             m_uctSearch.SetUseSaveBridge(cmd.Arg<bool>(1));
+        else if (name == "use_book")
+            m_useBook = cmd.Arg<bool>(1);
+        else if (name == "book_file")
+        {
+            try {
+                m_book.Load(cmd.Arg(1));
+            }
+            catch (const YException& e) {
+                throw GtpFailure() << e.what();
+            }
+            m_bookFile = cmd.Arg(1);
+        }
+        else if (name == "analysis_cache")
+        {
+            try {
+                m_analysisCache.Open(cmd.Arg(1), ANALYSIS_CACHE_ENTRIES);
+            }
+            catch (const YException& e) {
+                throw GtpFailure() << e.what();
+            }
+        }
+        else if (name == "endgame_db")
+        {
+            try {
+                m_endgameDb.Open(cmd.Arg(1));
+            }
+            catch (const YException& e) {
+                throw GtpFailure() << e.what();
+            }
+        }
+        else if (name == "analysis_cache_play_count")
+            m_analysisCachePlayCount = cmd.ArgMin<SgUctValue>(1, 0);
+        else if (name == "use_mustplay")
+            m_uctSearch.SetUseMustplay(cmd.Arg<bool>(1));
+        else if (name == "leaf_solve_empty")
+            m_uctSearch.SetLeafSolveEmpty(cmd.ArgMin<int>(1, 0));
+        else if (name == "leaf_solve_mustplay")
+            m_uctSearch.SetLeafSolveMustplay(cmd.ArgMin<int>(1, 0));
+        else if (name == "leaf_solve_nodes")
+            m_uctSearch.SetLeafSolveNodes(cmd.ArgMin<std::size_t>(1, 1));
+        else if (name == "use_symmetry_pruning")
+            m_uctSearch.SetUseSymmetryPruning(cmd.Arg<bool>(1));
+        else if (name == "use_transpositions")
+            m_uctSearch.SetUseTranspositions(cmd.Arg<bool>(1));
+        else if (name == "use_vc_termination")
+            m_uctSearch.SetUseVCTermination(cmd.Arg<bool>(1));
+        else if (name == "adaptive_expand_threshold")
+            m_uctSearch.SetAdaptiveExpandThreshold(cmd.Arg<bool>(1));
+        else if (name == "prune_full_tree")
+            m_uctSearch.SetPruneFullTree(cmd.Arg<bool>(1));
+        else if (name == "lock_free")
+            m_uctSearch.SetLockFree(cmd.Arg<bool>(1));
+        else if (name == "virtual_loss")
+            m_uctSearch.SetVirtualLoss(cmd.Arg<bool>(1));
         else if (name == "allow_swap")
             m_allowSwap = cmd.Arg<bool>(1);
+        else if (name == "early_stop")
+            m_uctSearch.SetEarlyStop(cmd.Arg<bool>(1));
         else if (name == "ignore_clock")
             m_ignoreClock = cmd.Arg<bool>(1);
+        else if (name == "ponder")
+            m_ponder = cmd.Arg<bool>(1);
+        else if (name == "reuse_subtree")
+            m_reuseSubtree = cmd.Arg<bool>(1);
+        else if (name == "solver_move_ordering")
+            m_search.SetMoveOrdering(cmd.Arg<bool>(1));
         else if (name == "bias_term_constant")
             m_uctSearch.SetBiasTermConstant(cmd.Arg<float>(1));
+        else if (name == "dfpn_epsilon")
+            m_dfpn.SetEpsilon(cmd.ArgMin<double>(1, 0.0));
+        else if (name == "dfpn_table_bits")
+            m_dfpn.SetTableBits(cmd.ArgMinMax<int>(1, 10, 30));
+        else if (name == "solver")
+        {
+            const std::string solver = cmd.Arg(1);
+            if (solver != "alphabeta" && solver != "dfpn")
+                throw GtpFailure() << "Unknown solver '" << solver << "'";
+            m_solver = solver;
+        }
+        else if (name == "solver_threads")
+            m_solverThreads = cmd.ArgMin<std::size_t>(1, 0);
+        else if (name == "early_stop_win_rate")
+            m_uctSearch.SetEarlyStopWinRate(cmd.ArgMinMax<float>(1, 0.0, 
+                                                                  0.5));
         else if (name == "expand_threshold")
             m_uctSearch.SetExpandThreshold(cmd.ArgMin<int>(1, 1));
+        else if (name == "light_playout_after")
+            m_uctSearch.SetLightPlayoutAfter(cmd.Arg<int>(1));
+        else if (name == "lockstep_lanes")
+            m_uctSearch.SetLockstepLanes(cmd.ArgMinMax<int>(1, 0, 
+                                         LockstepPlayouts::MAX_LANES));
         else if (name == "number_playouts")
             m_uctSearch.SetNumberPlayouts(cmd.ArgMin<int>(1, 1));
+        else if (name == "prior_count")
+            m_uctSearch.SetPriorCount(cmd.ArgMin<float>(1, 0.0));
+        else if (name == "root_workers")
+        {
+            try {
+                if (! m_rootWorker)
+                    m_rootParallel.SetNumWorkers(cmd.ArgMin<int>(1, 0));
+            }
+            catch (const YException& e) {
+                throw GtpFailure() << e.what();
+            }
+        }
+        else if (name == "progressive_bias")
+            m_uctSearch.SetProgressiveBias(cmd.ArgMin<float>(1, 0.0));
+        else if (name == "prune_min_count")
+            m_uctSearch.SetPruneMinCount(cmd.ArgMin<float>(1, 1.0));
         else if (name == "num_threads")
             m_uctSearch.SetNumberThreads(cmd.ArgMin<int>(1, 1));
         else if (name == "max_games")
@@ -547,6 +1153,17 @@ void YGtpEngine::CmdParam(GtpCommand& cmd)
             m_uctMaxTime = cmd.Arg<float>(1);
         else
             throw GtpFailure("Unknown parameter name!");
+        // Workers search the same way; only this process writes the
+        // analysis cache.
+        if (name != "root_workers" && name != "analysis_cache")
+        {
+            try {
+                m_rootParallel.SetParam(name, cmd.Arg(1));
+            }
+            catch (const YException& e) {
+                throw GtpFailure() << e.what();
+            }
+        }
     }
     else
         throw GtpFailure("Expected 0 or 2 parameters!");
@@ -619,9 +1236,23 @@ void YGtpEngine::CmdUctProvenNodes(GtpCommand& cmd)
     }
 }
 
+/** Prints the root moves of the last search, or of the analysis
+    cache if there is no search tree. */
 void YGtpEngine::CmdUctScores(GtpCommand& cmd)
 {
     const SgUctTree& tree = m_uctSearch.Tree();
+    const YAnalysisCache::Entry* cached 
+        = m_analysisCache.Lookup(m_brd, m_brd.ToPlay());
+    if (! tree.Root().HasChildren() && cached != 0)
+    {
+        for (int i = 0; i < cached->m_numChildren; ++i)
+            cmd << ' ' << m_brd.ToString(cached->m_children[i].m_move)
+                << ' ' << std::fixed << std::setprecision(3) 
+                << cached->m_children[i].m_value
+                << '@' << static_cast<std::size_t>(
+                                        cached->m_children[i].m_count);
+        return;
+    }
     for (SgUctChildIterator it(tree, tree.Root()); it; ++it)
     {
         const SgUctNode& child = *it;
@@ -653,14 +1284,275 @@ void YGtpEngine::CmdRaveScores(GtpCommand& cmd)
 
 void YGtpEngine::CmdPlayoutStatistics(GtpCommand& cmd)
 {
-    cmd << YUctSearch::PlayoutStatistics::Get().ToString();
+    cmd << m_uctSearch.GetPlayoutStatistics().ToString();
+}
+
+/** Worker side of root-parallel search: searches the current position
+    with the given color to move for the given time, reusing the tree
+    of the previous search, and prints "move count mean" for every root
+    move. Arguments: color seconds */
+void YGtpEngine::CmdUctRootSearch(GtpCommand& cmd)
+{
+    cmd.CheckNuArg(2);
+    const SgBlackWhite toPlay = ColorArg(cmd, 0);
+    const double seconds = cmd.ArgMin<double>(1, 0.0);
+    std::vector<SgMove> sequence;
+    UctSearch(toPlay, m_uctMaxGames, seconds, sequence);
+    const SgUctTree& tree = m_uctSearch.Tree();
+    for (SgUctChildIterator it(tree, tree.Root()); it; ++it)
+    {
+        const SgUctNode& child = *it;
+        if (child.MoveCount() > 0)
+            cmd << ' ' << m_brd.ToString(child.Move()) 
+                << ' ' << child.MoveCount() << ' ' << child.Mean();
+    }
+}
+
+/** Builds the opening book: plays each first move listed in the
+    openings file on an empty board of the current size and searches
+    the reply for the given time (with the root workers if any). The
+    best reply and its value are stored for every opening. The empty
+    board gets the opening whose value is closest to even, which is
+    the best first move when the opponent may swap. Entries are added
+    to the book file if it exists. Every opening gets the full time,
+    without early stop. The game in progress is restored afterwards;
+    the clocks are not changed.
+    Arguments: openings-file book-file [seconds] */
+void YGtpEngine::CmdBookExpand(GtpCommand& cmd)
+{
+    cmd.CheckNuArgLessEqual(3);
+    if (cmd.NuArg() < 2)
+        throw GtpFailure("Expected openings file and book file");
+    const std::string bookFile = cmd.Arg(1);
+    const double seconds = (cmd.NuArg() > 2) 
+        ? cmd.ArgMin<double>(2, 0.1) : 60.0;
+    std::ifstream in(cmd.Arg(0).c_str());
+    if (! in)
+        throw GtpFailure() << "Cannot read '" << cmd.Arg(0) << "'";
+    YBook book;
+    try {
+        book.Load(bookFile);
+    }
+    catch (const YException&) {
+        SgDebug() << "Starting new book '" << bookFile << "'\n";
+    }
+    Board game(m_brd.Size());
+    game.SetPosition(m_brd);
+    const bool ponderPending = m_ponderPending;
+    const bool oldEarlyStop = m_uctSearch.EarlyStop();
+    m_uctSearch.SetEarlyStop(false);
+    try {
+        ExpandBook(in, seconds, book, cmd);
+    }
+    catch (...) {
+        m_brd.SetPosition(game);
+        m_ponderPending = ponderPending;
+        m_uctSearch.SetEarlyStop(oldEarlyStop);
+        throw;
+    }
+    m_brd.SetPosition(game);
+    m_ponderPending = ponderPending;
+    m_uctSearch.SetEarlyStop(oldEarlyStop);
+    try {
+        book.Save(bookFile);
+    }
+    catch (const YException& e) {
+        throw GtpFailure() << e.what();
+    }
+}
+
+/** Searches the reply to every opening read from in, on an empty board
+    of the current size; see CmdBookExpand(). */
+void YGtpEngine::ExpandBook(std::istream& in, double seconds, YBook& book,
+                            GtpCommand& cmd)
+{
+    const int size = m_brd.Size();
+    m_brd.SetSize(size);
+    const SgHashCode emptyHash = m_brd.Hash();
+    SgMove fairest = SG_NULLMOVE;
+    float fairestValue = 0.0f;
+    std::string name;
+    while (in >> name)
+    {
+        const SgMove first = m_brd.Const().FromString(name);
+        if (! m_brd.Const().IsOnBoard(first))
+            throw GtpFailure() << "Invalid opening '" << name << "'";
+        m_brd.SetSize(size);
+        Play(SG_BLACK, first);
+        std::vector<SgMove> sequence;
+        const float value = (m_rootParallel.NumWorkers() > 0)
+            ? RootParallelSearch(SG_WHITE, m_uctMaxGames, seconds, sequence)
+            : UctSearch(SG_WHITE, m_uctMaxGames, seconds, sequence);
+        if (sequence.empty())
+            continue;
+        book.Add(m_brd.Hash(), SG_WHITE, sequence[0], value);
+        cmd << '\n' << name << ' ' << m_brd.ToString(sequence[0]) 
+            << ' ' << std::fixed << std::setprecision(3) << value;
+        if (fairest == SG_NULLMOVE 
+            || std::fabs(value - 0.5) < std::fabs(fairestValue - 0.5))
+        {
+            fairest = first;
+            fairestValue = value;
+        }
+    }
+    if (fairest != SG_NULLMOVE)
+        // White swaps if that is better, so black gets the worse side.
+        book.Add(emptyHash, SG_BLACK, fairest, 
+                 std::min(fairestValue, 1.0f - fairestValue));
+}
+
+/** Solves every position of the given board sizes and writes them to
+    an endgame database file, for y_param endgame_db. Sizes up to 5
+    take seconds; size 6 takes hours.
+    Arguments: file size... */
+void YGtpEngine::CmdEndgameDbBuild(GtpCommand& cmd)
+{
+    if (cmd.NuArg() < 2)
+        throw GtpFailure("Expected file and board sizes");
+    std::vector<int> sizes;
+    for (std::size_t i = 1; i < cmd.NuArg(); ++i)
+        sizes.push_back(cmd.ArgMinMax<int>(i, 1, YEndgameDb::MAX_SIZE));
+    try {
+        YEndgameDb::Build(sizes, cmd.Arg(0));
+    }
+    catch (const YException& e) {
+        throw GtpFailure() << e.what();
+    }
+}
+
+/** Writes the tree of the last search in the binary format of
+    YUctSearchUtil::DumpTree(), to checkpoint a long analysis.
+    The last search must be of the current position.
+    Arguments: file */
+void YGtpEngine::CmdUctTreeDump(GtpCommand& cmd)
+{
+    cmd.CheckNuArg(1);
+    if (! HasTreeOfPosition())
+        throw GtpFailure("No search tree of the current position");
+    std::ofstream out(cmd.Arg(0).c_str(), std::ios::binary);
+    if (! out)
+        throw GtpFailure() << "Cannot write '" << cmd.Arg(0) << "'";
+    try {
+        YUctSearchUtil::DumpTree(m_uctSearch.Tree(), m_brd, m_searchToPlay,
+                                 out);
+    }
+    catch (const YException& e) {
+        throw GtpFailure() << e.what();
+    }
+    cmd << m_uctSearch.Tree().NuNodes();
+}
+
+/** Loads a tree written by uct_tree_dump for the current position.
+    It becomes the tree of the last search: the next search of the
+    position continues it, and uct_scores shows it.
+    Arguments: file */
+void YGtpEngine::CmdUctTreeLoad(GtpCommand& cmd)
+{
+    cmd.CheckNuArg(1);
+    std::ifstream in(cmd.Arg(0).c_str(), std::ios::binary);
+    if (! in)
+        throw GtpFailure() << "Cannot read '" << cmd.Arg(0) << "'";
+    if (! m_uctSearch.ThreadsCreated())
+        m_uctSearch.CreateThreads();
+    SgUctTree& tree = m_uctSearch.GetTempTree();
+    SgBlackWhite toPlay;
+    try {
+        toPlay = YUctSearchUtil::LoadTree(tree, m_brd, in);
+    }
+    catch (const YException& e) {
+        m_searchSize = -1;
+        throw GtpFailure() << e.what();
+    }
+    const std::size_t nuNodes = tree.NuNodes();
+    // A search without games installs the tree.
+    const bool oldEarlyStop = m_uctSearch.EarlyStop();
+    m_uctSearch.SetEarlyStop(false);
+    std::vector<SgMove> sequence;
+    UctSearch(toPlay, 0, 0.0, sequence, &tree);
+    m_uctSearch.SetEarlyStop(oldEarlyStop);
+    cmd << nuNodes;
+}
+
+/** Writes the tree of the last search as sgf, down to the given depth
+    (default 2; -1 for the whole tree, only for small trees).
+    Arguments: file [max_depth] */
+void YGtpEngine::CmdUctTreeSgf(GtpCommand& cmd)
+{
+    cmd.CheckNuArgLessEqual(2);
+    if (cmd.NuArg() < 1)
+        throw GtpFailure("Expected file");
+    const int maxDepth = (cmd.NuArg() > 1) ? cmd.ArgMin<int>(1, -1) : 2;
+    if (! HasTreeOfPosition())
+        throw GtpFailure("No search tree of the current position");
+    std::ofstream out(cmd.Arg(0).c_str());
+    if (! out)
+        throw GtpFailure() << "Cannot write '" << cmd.Arg(0) << "'";
+    YUctSearchUtil::SaveTree(m_uctSearch.Tree(), m_brd, m_searchToPlay, 
+                             out, maxDepth);
+}
+
+/** Searches the current position for a fixed time with 1, 2, 4, ...
+    threads, up to the given maximum (default: number of cores), and
+    reports games and moves per second, tree size and the speedup
+    over one thread. The early stop is disabled while measuring.
+    Arguments: [max_threads [seconds]] */
+void YGtpEngine::CmdUctScaling(GtpCommand& cmd)
+{
+    cmd.CheckNuArgLessEqual(2);
+    unsigned int maxThreads = boost::thread::hardware_concurrency();
+    if (maxThreads == 0)
+        maxThreads = m_uctSearch.NumberThreads();
+    if (cmd.NuArg() > 0)
+        maxThreads = cmd.ArgMin<unsigned int>(0, 1);
+    const double seconds = (cmd.NuArg() > 1) 
+        ? cmd.ArgMin<double>(1, 0.1) : 10.0;
+
+    const unsigned int oldThreads = m_uctSearch.NumberThreads();
+    const bool oldEarlyStop = m_uctSearch.EarlyStop();
+    m_uctSearch.SetEarlyStop(false);
+    m_uctSearch.SetPosition(m_brd);
+    // The benchmark trees are not related to the game.
+    m_searchSize = -1;
+    double baseGamesPerSecond = 0.0;
+    cmd << "\nthreads games/s moves/s nodes speedup\n";
+    for (unsigned int numThreads = 1; ; numThreads *= 2)
+    {
+        if (numThreads > maxThreads)
+            numThreads = maxThreads;
+        m_uctSearch.SetNumberThreads(numThreads);
+        std::vector<SgMove> sequence;
+        SgTimer timer;
+        m_uctSearch.Search(std::numeric_limits<SgUctValue>::max(), 
+                           seconds, sequence);
+        timer.Stop();
+        if (SgUserAbort())
+            break;
+        const double time = timer.GetTime();
+        const SgUctSearchStat& stat = m_uctSearch.Statistics();
+        const double games = m_uctSearch.GamesPlayed();
+        const double gamesPerSecond = games / time;
+        const double movesPerSecond 
+            = games * stat.m_gameLength.Mean() / time;
+        if (numThreads == 1)
+            baseGamesPerSecond = gamesPerSecond;
+        cmd << numThreads << ' ' 
+            << std::fixed << std::setprecision(0) << gamesPerSecond << ' '
+            << movesPerSecond << ' '
+            << m_uctSearch.Tree().NuNodes() << ' '
+            << std::setprecision(2) << gamesPerSecond / baseGamesPerSecond
+            << '\n';
+        if (numThreads == maxThreads)
+            break;
+    }
+    m_uctSearch.SetNumberThreads(oldThreads);
+    m_uctSearch.SetEarlyStop(oldEarlyStop);
 }
 
 //----------------------------------------------------------------------------
 
 void YGtpEngine::CmdBoardStatistics(GtpCommand& cmd)
 {
-    cmd << Board::Statistics::Get().ToString();
+    cmd << m_uctSearch.GetBoardStatistics().ToString();
 }
 
 //----------------------------------------------------------------------------
@@ -11,6 +11,12 @@
 #include "GtpEngine.h"
 #include "SgBWArray.h"
 #include "Board.h"
+#include "YAnalysisCache.h"
+#include "YBook.h"
+#include "YDfpnSolver.h"
+#include "YEndgameDb.h"
+#include "YParallelSolver.h"
+#include "YRootParallel.h"
 #include "YSearch.h"
 #include "YUctSearch.h"
 
@@ -55,6 +61,13 @@ public:
     void CmdPlayoutMove(GtpCommand& cmd);
     void CmdPlayoutWeights(GtpCommand& cmd);
     void CmdPlayoutStatistics(GtpCommand& cmd);
+    void CmdUctScaling(GtpCommand& cmd);
+    void CmdUctRootSearch(GtpCommand& cmd);
+    void CmdBookExpand(GtpCommand& cmd);
+    void CmdEndgameDbBuild(GtpCommand& cmd);
+    void CmdUctTreeDump(GtpCommand& cmd);
+    void CmdUctTreeLoad(GtpCommand& cmd);
+    void CmdUctTreeSgf(GtpCommand& cmd);
 
     void CmdFinalScore(GtpCommand& cmd);
     void CmdVersion(GtpCommand& cmd);
@@ -86,11 +99,36 @@ public:
 
     // @}
 
+    /** Runs the commands of a config file. Root-parallel workers
+        run the same file when they start. */
+    void ExecuteConfig(const std::string& filename);
+
+    /** Ignore y_param root_workers, in a process that is itself a
+        root-parallel worker. */
+    void SetRootWorker(bool f) { m_rootWorker = f; }
+
+    /** Analyzes the positions read from in and writes the results to
+        out as JSON lines; see YPositionReader for the input format. */
+    void AnalyzeBatch(std::istream& in, std::ostream& out,
+                      std::size_t numChildren);
+
 #if GTPENGINE_INTERRUPT
     /** Calls SgSetUserAbort(). */
     void Interrupt();
 #endif
 
+#if GTPENGINE_PONDER
+    /** Clears the user abort flag before pondering starts. */
+    void InitPonder();
+
+    /** Searches the current position while the opponent thinks, if
+        pondering is enabled and our move was the last one played. */
+    void Ponder();
+
+    /** Calls SgSetUserAbort(). */
+    void StopPonder();
+#endif
+
 protected:
     /* Clears SgAbortFlag() */
     void BeforeHandleCommand();
@@ -100,14 +138,64 @@ protected:
 
 private:
 
+    /** Fewest moves TimeForMove() assumes are left. */
+    static const int MIN_MOVES_LEFT = 5;
+
+    /** Seconds between two merges of the root-parallel statistics. */
+    static const double ROOT_PARALLEL_ROUND;
+
+    /** Entries of a new analysis cache file (about 3.5MB). */
+    static const std::size_t ANALYSIS_CACHE_ENTRIES = 16384;
+
     Board m_brd;
 
     YSearch m_search;
 
+    /** Solver used by y_solve: "dfpn" or "alphabeta". */
+    std::string m_solver;
+
+    YDfpnSolver m_dfpn;
+
+    /** Threads of the df-pn solver; 0 for num_threads. */
+    std::size_t m_solverThreads;
+
+    /** Runs df-pn when it has more than one thread; shares the table
+        of m_dfpn. */
+    YParallelSolver m_parallelSolver;
+
     SgSearchHashTable m_hashTable;
 
     YUctSearch m_uctSearch;
 
+    /** Consult m_book in genmove. */
+    bool m_useBook;
+
+    /** File m_book was loaded from; set with y_param book_file. */
+    std::string m_bookFile;
+
+    YBook m_book;
+
+    /** Root statistics of earlier searches; opened with y_param
+        analysis_cache. */
+    YAnalysisCache m_analysisCache;
+
+    /** Genmove plays the cached best move without searching if the
+        cached search had at least this many games; 0 never does. */
+    SgUctValue m_analysisCachePlayCount;
+
+    /** Copy of the cache entry the root of the current tree was
+        seeded with, valid if m_hasRootSeed. */
+    YAnalysisCache::Entry m_rootSeed;
+
+    bool m_hasRootSeed;
+
+    /** Solved positions of small boards, used by all searches; opened
+        with y_param endgame_db. */
+    YEndgameDb m_endgameDb;
+
+    /** Worker processes for root-parallel search; none by default. */
+    YRootParallel m_rootParallel;
+
     std::size_t m_uctMaxGames;
 
     double m_uctMaxTime;
@@ -123,6 +211,26 @@ private:
     bool m_ignoreClock;
 
     bool m_allowSwap;
+
+    /** Seed each search with the matching subtree of the last one. */
+    bool m_reuseSubtree;
+
+    /** Position searched by the last call to GenMove(). */
+    Board::History m_searchHistory;
+
+    int m_searchSize;
+
+    SgBlackWhite m_searchToPlay;
+
+    /** Search during the opponent's turn. */
+    bool m_ponder;
+
+    /** Set after genmove; cleared by anything that changes the
+        position. */
+    bool m_ponderPending;
+
+    /** See SetRootWorker(). */
+    bool m_rootWorker;
    
     SgBlackWhite BlackWhiteArg(const GtpCommand& cmd, 
                                std::size_t number) const;
@@ -131,6 +239,28 @@ private:
 
     int GenMove(bool useGameClock, int toPlay);
 
+    bool FindInitTree(SgUctTree& initTree, SgBlackWhite toPlay, 
+                      double maxTime) const;
+
+    SgMove SolvedRootMove(SgBlackWhite toPlay, double maxTime);
+
+    double TimeForMove(double timeLeft) const;
+
+    SgUctValue RootParallelSearch(SgBlackWhite toPlay, std::size_t maxGames,
+                                  double maxTime, 
+                                  std::vector<SgMove>& sequence);
+
+    SgUctValue UctSearch(SgBlackWhite toPlay, std::size_t maxGames, 
+                         double maxTime, std::vector<SgMove>& sequence,
+                         SgUctTree* initTree = 0, double moveTime = 0);
+
+    bool HasTreeOfPosition() const;
+
+    void SolveDfpn(GtpCommand& cmd, SgBlackWhite toPlay, double timelimit);
+
+    void ExpandBook(std::istream& in, double seconds, YBook& book, 
+                    GtpCommand& cmd);
+
     int CellArg(const GtpCommand& cmd, std::size_t number) const;
    
     void Play(SgBlackWhite color, int cell);
@@ -1,5 +1,6 @@
 //---------------------------------------------------------------------------
 
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -36,6 +37,12 @@ int g_tracing_level = 0;
 
 int g_boardSize = 13;
 
+std::string g_analyzeFile;
+
+std::size_t g_analyzeChildren = 5;
+
+bool g_rootWorker = false;
+
 void Usage()
 {
     std::cout << '\n'
@@ -43,6 +50,8 @@ void Usage()
               << '\n' 
               << "       y [Options]" 
               << '\n' 
+              << "       y [Options] --analyze positions.txt" 
+              << '\n' 
               << '\n'
               << "[OPTIONS] is any number of the following:"
               << '\n' 
@@ -66,7 +75,18 @@ void AddCommandLineArguments()
          "Boardsize to use at startup.")
         ("config", 
          po::value<std::string>(&g_config_file)->default_value(""),
-         "Sets the config file to parse.");
+         "Sets the config file to parse.")
+        ("analyze", 
+         po::value<std::string>(&g_analyzeFile)->default_value(""),
+         "Analyzes each position of the file (an encoded history or an "
+         "sgf file per line) with the max_games and max_time of the "
+         "config and writes JSON lines instead of running GTP.")
+        ("analyze-children", 
+         po::value<std::size_t>(&g_analyzeChildren)->default_value(5),
+         "Root moves written per analyzed position.")
+        ("root-worker", 
+         "Runs as a worker of a root-parallel search; set by the "
+         "coordinator.");
 }
 
 void ProcessCommandLineArguments(int argc, char** argv)
@@ -95,6 +115,8 @@ void ProcessCommandLineArguments(int argc, char** argv)
     }
     if (vm.count("verbose"))
         g_tracing_level = 1;
+    if (vm.count("root-worker"))
+        g_rootWorker = true;
 }
 
 }
@@ -111,11 +133,25 @@ int main(int argc, char** argv)
     SgRandom::SetSeed(g_seed);
 
     YGtpEngine engine(g_boardSize);
+    engine.SetRootWorker(g_rootWorker);
     if (g_config_file != "")
-        engine.ExecuteFile(g_config_file);
-    GtpInputStream gin(std::cin);
-    GtpOutputStream gout(std::cout);
-    engine.MainLoop(gin, gout);
+        engine.ExecuteConfig(g_config_file);
+    if (g_analyzeFile != "")
+    {
+        std::ifstream positions(g_analyzeFile.c_str());
+        if (! positions)
+        {
+            std::cerr << "Cannot read '" << g_analyzeFile << "'\n";
+            return 1;
+        }
+        engine.AnalyzeBatch(positions, std::cout, g_analyzeChildren);
+    }
+    else
+    {
+        GtpInputStream gin(std::cin);
+        GtpOutputStream gout(std::cout);
+        engine.MainLoop(gin, gout);
+    }
 
     SgFini();
     //HavannahFini();
@@ -0,0 +1,300 @@
+#include "SgSystem.h"
+
+#include "YParallelSolver.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+struct MoveWeight
+{
+    SgMove m_move;
+
+    float m_weight;
+
+    bool operator<(const MoveWeight& other) const
+    { return m_weight > other.m_weight; }
+};
+
+}
+
+//---------------------------------------------------------------------------
+
+YParallelSolver::Worker::Worker(YDfpnTable& table, int size)
+    : m_solver(table),
+      m_brd(size),
+      m_abort(false),
+      m_child(-1)
+{
+}
+
+//---------------------------------------------------------------------------
+
+YParallelSolver::YParallelSolver()
+    : m_numThreads(1),
+      m_epsilon(0.25),
+      m_endgameDb(0),
+      m_root(0),
+      m_toPlay(SG_BLACK),
+      m_maxTime(0),
+      m_numRefuted(0),
+      m_done(false),
+      m_winner(SG_EMPTY),
+      m_move(SG_NULLMOVE),
+      m_numNodes(0),
+      m_maxDepth(0)
+{
+}
+
+SgBoardColor YParallelSolver::Solve(const Board& brd, SgBlackWhite toPlay,
+                                    double maxTime, YDfpnTable& table,
+                                    SgMove& move)
+{
+    m_root = &brd;
+    m_toPlay = toPlay;
+    m_maxTime = maxTime;
+    m_numRefuted = 0;
+    m_done = false;
+    m_winner = SG_EMPTY;
+    m_move = SG_NULLMOVE;
+    m_numNodes = 0;
+    m_maxDepth = 0;
+    m_timer.Start();
+    move = SG_NULLMOVE;
+    if (brd.HasWinningVC())
+        return brd.GetVCWinner();
+    if (brd.IsGameOver())
+        return brd.GetWinner();
+
+    const std::size_t numThreads = std::max<std::size_t>(m_numThreads, 1);
+    m_workers.clear();
+    for (std::size_t i = 0; i < numThreads; ++i)
+    {
+        boost::shared_ptr<Worker> worker(new Worker(table, brd.Size()));
+        worker->m_solver.SetEpsilon(m_epsilon);
+        worker->m_solver.SetAbortFlag(&worker->m_abort);
+        worker->m_solver.SetEndgameDb(m_endgameDb);
+        m_workers.push_back(worker);
+    }
+    std::vector<SgMove> moves;
+    m_workers[0]->m_brd.SetPosition(brd);
+    GenerateMoves(m_workers[0]->m_brd, toPlay, moves);
+    if (moves.empty())
+    {
+        m_workers.clear();
+        return SgOppBW(toPlay);
+    }
+    m_children.clear();
+    for (std::size_t i = 0; i < moves.size(); ++i)
+    {
+        RootChild child;
+        child.m_move = moves[i];
+        child.m_result = SG_EMPTY;
+        child.m_openReplies = 0;
+        m_children.push_back(child);
+    }
+    CreateTasks(m_children.size() < SPLIT_FACTOR * numThreads);
+
+    boost::thread_group threads;
+    for (std::size_t i = 0; i < numThreads; ++i)
+        threads.create_thread(boost::bind(&YParallelSolver::Run, this, i));
+    threads.join_all();
+    m_workers.clear();
+    move = m_move;
+    return m_winner;
+}
+
+/** Symmetry representatives of the mustplay, best weight first;
+    none if every move loses. */
+void YParallelSolver::GenerateMoves(Board& brd, SgBlackWhite toPlay,
+                                    std::vector<SgMove>& moves) const
+{
+    std::vector<MoveWeight> weighted;
+    Board::SymmetryList symmetries;
+    brd.GetSymmetries(symmetries);
+    MarkedCells mustplay;
+    const bool restricted = brd.ComputeMustplay(toPlay, mustplay);
+    for (Board::EmptyIterator it(brd); it; ++it)
+        if ((! restricted || mustplay.Marked(*it))
+            && brd.IsSymmetryRepresentative(*it, symmetries, 
+                                           restricted ? &mustplay : 0))
+        {
+            MoveWeight m;
+            m.m_move = *it;
+            m.m_weight = brd.WeightCell(*it);
+            weighted.push_back(m);
+        }
+    std::stable_sort(weighted.begin(), weighted.end());
+    moves.clear();
+    for (std::size_t i = 0; i < weighted.size(); ++i)
+        moves.push_back(weighted[i].m_move);
+}
+
+/** Deals the tasks out to the workers in turn, so that every worker
+    starts with one of the most promising moves and the replies to a
+    root move are solved side by side. Root moves that end the game
+    get their result here, and so do root moves that leave the
+    opponent no move outside of its mustplay. */
+void YParallelSolver::CreateTasks(bool splitReplies)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::vector<Task> tasks;
+    Board& brd = m_workers[0]->m_brd;
+    std::vector<SgMove> replies;
+    for (std::size_t i = 0; i < m_children.size(); ++i)
+    {
+        Task task;
+        task.m_child = i;
+        task.m_reply = SG_NULLMOVE;
+        if (! splitReplies)
+        {
+            tasks.push_back(task);
+            continue;
+        }
+        brd.SetPosition(*m_root);
+        brd.Play(m_toPlay, static_cast<cell_t>(m_children[i].m_move));
+        if (brd.HasWinningVC() || brd.IsGameOver())
+        {
+            SetChildResult(i, brd.HasWinningVC()
+                           ? brd.GetVCWinner() : brd.GetWinner());
+            if (m_done)
+                return;
+            continue;
+        }
+        GenerateMoves(brd, SgOppBW(m_toPlay), replies);
+        if (replies.empty())
+        {
+            SetChildResult(i, m_toPlay);
+            return;
+        }
+        m_children[i].m_openReplies = replies.size();
+        for (std::size_t j = 0; j < replies.size(); ++j)
+        {
+            task.m_reply = replies[j];
+            tasks.push_back(task);
+        }
+    }
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+        m_workers[i % m_workers.size()]->m_tasks.push_back(tasks[i]);
+}
+
+bool YParallelSolver::NextTask(std::size_t id, Task& task)
+{
+    {
+        Worker& worker = *m_workers[id];
+        boost::mutex::scoped_lock lock(worker.m_mutex);
+        if (! worker.m_tasks.empty())
+        {
+            task = worker.m_tasks.front();
+            worker.m_tasks.pop_front();
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < m_workers.size(); ++i)
+    {
+        Worker& victim = *m_workers[(id + i) % m_workers.size()];
+        boost::mutex::scoped_lock lock(victim.m_mutex);
+        if (! victim.m_tasks.empty())
+        {
+            task = victim.m_tasks.back();
+            victim.m_tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void YParallelSolver::Run(std::size_t id)
+{
+    Worker& worker = *m_workers[id];
+    Task task;
+    while (! m_done && NextTask(id, task))
+        SolveTask(worker, task);
+}
+
+void YParallelSolver::SolveTask(Worker& worker, const Task& task)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_done || m_children[task.m_child].m_result != SG_EMPTY)
+            return;
+        worker.m_child = static_cast<int>(task.m_child);
+        worker.m_abort = false;
+    }
+    const double timeLeft = m_maxTime - m_timer.GetTime();
+    const bool outOfTime = timeLeft <= 0 || SgUserAbort();
+    SgBoardColor winner = SG_EMPTY;
+    int ply = 0;
+    if (! outOfTime)
+    {
+        // m_move of the root children does not change during the search.
+        worker.m_brd.SetPosition(*m_root);
+        const SgMove rootMove = m_children[task.m_child].m_move;
+        worker.m_brd.Play(m_toPlay, static_cast<cell_t>(rootMove));
+        SgBlackWhite toPlay = SgOppBW(m_toPlay);
+        ply = 1;
+        if (task.m_reply != SG_NULLMOVE)
+        {
+            worker.m_brd.Play(toPlay, static_cast<cell_t>(task.m_reply));
+            toPlay = SgOppBW(toPlay);
+            ply = 2;
+        }
+        SgMove move;
+        winner = worker.m_solver.Solve(worker.m_brd, toPlay, timeLeft, move);
+    }
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    worker.m_child = -1;
+    if (outOfTime)
+    {
+        Finish();
+        return;
+    }
+    m_numNodes += worker.m_solver.NumNodes();
+    m_maxDepth = std::max(m_maxDepth, ply + worker.m_solver.MaxDepth());
+    RootChild& child = m_children[task.m_child];
+    if (winner == SG_EMPTY || m_done || child.m_result != SG_EMPTY)
+        return;
+    if (task.m_reply == SG_NULLMOVE || winner != m_toPlay)
+        SetChildResult(task.m_child, winner);
+    else if (--child.m_openReplies == 0)
+        SetChildResult(task.m_child, m_toPlay);
+}
+
+/** Records the winner after a root move and stops the work that no
+    longer matters. Call with m_mutex held. */
+void YParallelSolver::SetChildResult(std::size_t index, SgBoardColor result)
+{
+    RootChild& child = m_children[index];
+    child.m_result = result;
+    if (result == m_toPlay)
+    {
+        m_winner = m_toPlay;
+        m_move = child.m_move;
+        Finish();
+        return;
+    }
+    if (++m_numRefuted == m_children.size())
+    {
+        m_winner = SgOppBW(m_toPlay);
+        Finish();
+        return;
+    }
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        if (m_workers[i]->m_child == static_cast<int>(index))
+            m_workers[i]->m_abort = true;
+}
+
+/** Call with m_mutex held. */
+void YParallelSolver::Finish()
+{
+    m_done = true;
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        m_workers[i]->m_abort = true;
+}
+
+//---------------------------------------------------------------------------
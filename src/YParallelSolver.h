@@ -0,0 +1,151 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgBlackWhite.h"
+#include "SgMove.h"
+#include "SgTimer.h"
+
+#include "Board.h"
+#include "YDfpnSolver.h"
+
+#include <deque>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+//---------------------------------------------------------------------------
+
+/** Df-pn on several threads.
+    The moves at the root, and if there are few of them also the
+    replies to each, are split into tasks. Every worker thread solves
+    tasks with its own YDfpnSolver and Board; all solvers share one
+    YDfpnTable, so that work on transpositions is not repeated.
+    Workers take tasks from the front of their own queue and steal
+    from the back of the others when it is empty.
+    A root move that is proven to win ends the search at once; a reply
+    that refutes a root move stops the workers on the other replies to
+    that move. */
+class YParallelSolver
+{
+public:
+    YParallelSolver();
+
+    std::size_t NumThreads() const { return m_numThreads; }
+    void SetNumThreads(std::size_t n) { m_numThreads = n; }
+
+    /** See YDfpnSolver::SetEndgameDb(). */
+    void SetEndgameDb(const YEndgameDb* db) { m_endgameDb = db; }
+
+    /** Epsilon of the solvers, see YDfpnSolver::Epsilon(). */
+    double Epsilon() const    { return m_epsilon; }
+    void SetEpsilon(double e) { m_epsilon = e; }
+
+    /** Solves brd with toPlay to move within maxTime seconds, using
+        table for all workers. Returns the winner, or SG_EMPTY if the
+        search did not finish; if toPlay wins, move is a winning
+        move. */
+    SgBoardColor Solve(const Board& brd, SgBlackWhite toPlay, double maxTime,
+                       YDfpnTable& table, SgMove& move);
+
+    /** Positions expanded by all workers in the last Solve(). */
+    std::size_t NumNodes() const { return m_numNodes; }
+
+    /** Deepest ply from the root reached in the last Solve(). */
+    int MaxDepth() const { return m_maxDepth; }
+
+private:
+    /** Root moves per thread below which the replies are split into
+        tasks as well. */
+    static const std::size_t SPLIT_FACTOR = 4;
+
+    /** A root move, or a reply to one if m_reply is not
+        SG_NULLMOVE. */
+    struct Task
+    {
+        std::size_t m_child;
+
+        SgMove m_reply;
+    };
+
+    struct RootChild
+    {
+        SgMove m_move;
+
+        /** Winner of the game after m_move; SG_EMPTY while open. */
+        SgBoardColor m_result;
+
+        /** Replies not yet proven to lose for the opponent. */
+        std::size_t m_openReplies;
+    };
+
+    struct Worker
+    {
+        Worker(YDfpnTable& table, int size);
+
+        YDfpnSolver m_solver;
+
+        Board m_brd;
+
+        /** Protected by m_mutex. */
+        std::deque<Task> m_tasks;
+
+        boost::mutex m_mutex;
+
+        /** Set to stop the current task. */
+        volatile bool m_abort;
+
+        /** Root child of the current task, or -1. Protected by
+            YParallelSolver::m_mutex. */
+        int m_child;
+    };
+
+    std::size_t m_numThreads;
+
+    double m_epsilon;
+
+    const YEndgameDb* m_endgameDb;
+
+    const Board* m_root;
+
+    SgBlackWhite m_toPlay;
+
+    double m_maxTime;
+
+    SgTimer m_timer;
+
+    std::vector<boost::shared_ptr<Worker> > m_workers;
+
+    /** Protects the results below and Worker::m_child. */
+    boost::mutex m_mutex;
+
+    std::vector<RootChild> m_children;
+
+    std::size_t m_numRefuted;
+
+    volatile bool m_done;
+
+    SgBoardColor m_winner;
+
+    SgMove m_move;
+
+    std::size_t m_numNodes;
+
+    int m_maxDepth;
+
+    void GenerateMoves(Board& brd, SgBlackWhite toPlay,
+                       std::vector<SgMove>& moves) const;
+
+    void CreateTasks(bool splitReplies);
+
+    bool NextTask(std::size_t id, Task& task);
+
+    void Run(std::size_t id);
+
+    void SolveTask(Worker& worker, const Task& task);
+
+    void SetChildResult(std::size_t index, SgBoardColor result);
+
+    void Finish();
+};
+
+//---------------------------------------------------------------------------
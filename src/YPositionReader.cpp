@@ -0,0 +1,200 @@
+#include "SgSystem.h"
+#include "SgGameReader.h"
+#include "SgNode.h"
+
+#include "YPositionReader.h"
+#include "YException.h"
+#include "YSgUtil.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <boost/bind.hpp>
+
+//---------------------------------------------------------------------------
+
+namespace {
+
+bool IsHexDigit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')
+        || (c >= 'A' && c <= 'F');
+}
+
+bool EndsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size()
+        && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}
+
+//---------------------------------------------------------------------------
+
+YPositionReader::YPositionReader(std::istream& in)
+    : m_in(in),
+      m_done(false),
+      m_stop(false),
+      m_thread(boost::bind(&YPositionReader::Run, this))
+{
+}
+
+YPositionReader::~YPositionReader()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_changed.notify_all();
+    m_thread.join();
+}
+
+bool YPositionReader::Next(Position& position)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_positions.empty() && ! m_done)
+        m_changed.wait(lock);
+    if (m_positions.empty())
+        return false;
+    position = m_positions.front();
+    m_positions.pop_front();
+    m_changed.notify_all();
+    return true;
+}
+
+void YPositionReader::Run()
+{
+    std::string line;
+    while (std::getline(m_in, line))
+    {
+        const std::size_t end = line.find_last_not_of(" \t\r");
+        line.erase(end == std::string::npos ? 0 : end + 1);
+        line.erase(0, line.find_first_not_of(" \t"));
+        if (line.empty() || line[0] == '#')
+            continue;
+        Position position;
+        position.m_name = line;
+        SetUp(position);
+        boost::mutex::scoped_lock lock(m_mutex);
+        while (m_positions.size() >= READ_AHEAD && ! m_stop)
+            m_changed.wait(lock);
+        if (m_stop)
+            return;
+        m_positions.push_back(position);
+        m_changed.notify_all();
+    }
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_done = true;
+    m_changed.notify_all();
+}
+
+void YPositionReader::SetUp(Position& position)
+{
+    try {
+        position.m_brd.reset(EndsWith(position.m_name, ".sgf")
+                             ? ReadSgf(position.m_name)
+                             : ReadHistory(position.m_name));
+    }
+    catch (const YException& e) {
+        position.m_error = e.what();
+        position.m_brd.reset();
+    }
+}
+
+/** See Board::EncodeHistory(). */
+Board* YPositionReader::ReadHistory(const std::string& history)
+{
+    if (history.size() < 2 || history.size() % 2 != 0)
+        throw YException("Invalid history length");
+    for (std::size_t i = 0; i < history.size(); ++i)
+        if (! IsHexDigit(history[i]))
+            throw YException("Invalid history");
+    // A color marker "00" must be followed by a color and a move.
+    for (std::size_t i = 2; i < history.size(); i += 2)
+        if (history.compare(i, 2, "00") == 0)
+        {
+            if (i + 6 > history.size())
+                throw YException("Truncated history");
+            i += 2;
+        }
+    const int size = std::strtol(history.substr(0, 2).c_str(), 0, 16);
+    if (size < 1 || size > Y_MAX_SIZE)
+        throw YException() << "Invalid board size " << size;
+    std::auto_ptr<Board> brd(new Board(size));
+    Board::History moves;
+    brd->DecodeHistory(history, moves);
+    for (int i = 0; i < moves.m_move.Length(); ++i)
+        Play(*brd, moves.m_color[i], moves.m_move[i]);
+    return brd.release();
+}
+
+/** Plays the setup stones and the moves of the main line, like
+    loadsgf. */
+Board* YPositionReader::ReadSgf(const std::string& filename)
+{
+    std::ifstream file(filename.c_str());
+    if (! file)
+        throw YException() << "Cannot read '" << filename << "'";
+    SgGameReader reader(file, 13);
+    SgNode* root = reader.ReadGame();
+    if (root == 0)
+        throw YException() << "Cannot read game from '" << filename << "'";
+    const int size = root->GetIntProp(SG_PROP_SIZE);
+    std::auto_ptr<Board> brd;
+    try {
+        if (size < 1 || size > Y_MAX_SIZE)
+            throw YException() << "Invalid board size " << size;
+        brd.reset(new Board(size));
+        for (SgNode* node = root; node != 0;
+             node = node->NodeInDirection(SgNode::NEXT))
+        {
+            if (YSgUtil::NodeHasSetupInfo(node))
+            {
+                std::vector<cell_t> black, white, empty;
+                YSgUtil::GetSetupPosition(node, brd->Const(),
+                                          black, white, empty);
+                for (std::size_t i = 0;
+                     i < std::max(black.size(), white.size()); ++i)
+                {
+                    if (i < black.size())
+                        Play(*brd, SG_BLACK, black[i]);
+                    if (i < white.size())
+                        Play(*brd, SG_WHITE, white[i]);
+                }
+            }
+            else if (node->HasNodeMove())
+                Play(*brd, node->NodePlayer(),
+                     YSgUtil::SgPointToYPoint(node->NodeMove(),
+                                              brd->Const()));
+        }
+    }
+    catch (const YException&) {
+        root->DeleteTree();
+        throw;
+    }
+    root->DeleteTree();
+    return brd.release();
+}
+
+/** Plays a move of a history, checking it like the play command
+    does. Swap is stored with color SG_EMPTY. */
+void YPositionReader::Play(Board& brd, SgBoardColor color, SgMove move)
+{
+    if (move == Y_SWAP)
+    {
+        if (brd.NumMoves() != 1)
+            throw YException("Swap after the first move");
+        brd.Swap();
+        return;
+    }
+    if (! SgIsBlackWhite(color))
+        throw YException("Invalid color in history");
+    if (move < 0 || move >= Y_MAX_CELL || ! brd.Const().IsOnBoard(move))
+        throw YException() << "Invalid move " << move;
+    if (brd.IsOccupied(move))
+        throw YException() << "Occupied cell " << brd.ToString(move);
+    brd.Play(color, move);
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "SgSystem.h"
+
+#include "Board.h"
+
+#include <deque>
+#include <istream>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+//---------------------------------------------------------------------------
+
+/** Reads the positions of a batch analysis on a background thread, so
+    that the next positions are set up while the current one is
+    searched.
+    Each line of the input is either an encoded history, as written by
+    encode-history, or the name of an SGF file (ending in ".sgf"),
+    whose main line is played to the end. Empty lines and lines
+    starting with '#' are skipped. */
+class YPositionReader
+{
+public:
+    /** Positions set up ahead of the one returned by Next(). */
+    static const std::size_t READ_AHEAD = 4;
+
+    struct Position
+    {
+        /** The input line. */
+        std::string m_name;
+
+        /** Why the position could not be set up; empty if it was. */
+        std::string m_error;
+
+        boost::shared_ptr<Board> m_brd;
+    };
+
+    /** Starts reading; in must outlive the reader. */
+    explicit YPositionReader(std::istream& in);
+
+    ~YPositionReader();
+
+    /** Waits for the next position. Returns false at the end of the
+        input. */
+    bool Next(Position& position);
+
+private:
+    std::istream& m_in;
+
+    /** Protects the members below. */
+    boost::mutex m_mutex;
+
+    boost::condition_variable m_changed;
+
+    std::deque<Position> m_positions;
+
+    /** Set by the reader at the end of the input. */
+    bool m_done;
+
+    /** Set by the destructor. */
+    bool m_stop;
+
+    boost::thread m_thread;
+
+    void Run();
+
+    static void SetUp(Position& position);
+
+    static Board* ReadHistory(const std::string& history);
+
+    static Board* ReadSgf(const std::string& filename);
+
+    static void Play(Board& brd, SgBoardColor color, SgMove move);
+};
+
+//---------------------------------------------------------------------------
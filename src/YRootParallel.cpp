@@ -0,0 +1,284 @@
+#include "SgSystem.h"
+#include "SgRandom.h"
+
+#include "YRootParallel.h"
+#include "Board.h"
+#include "YException.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------------
+
+RootStatistics::RootStatistics()
+{
+    Clear();
+}
+
+void RootStatistics::Clear()
+{
+    memset(m_count, 0, sizeof(m_count));
+    memset(m_valueSum, 0, sizeof(m_valueSum));
+}
+
+void RootStatistics::Add(SgMove move, double count, double mean)
+{
+    SG_ASSERT(move >= 0 && move < Y_MAX_CELL);
+    m_count[move] += count;
+    m_valueSum[move] += count * mean;
+}
+
+double RootStatistics::Mean(SgMove move) const
+{
+    if (m_count[move] == 0)
+        return 0.5;
+    return m_valueSum[move] / m_count[move];
+}
+
+SgMove RootStatistics::BestMove() const
+{
+    SgMove best = SG_NULLMOVE;
+    for (int i = 0; i < Y_MAX_CELL; ++i)
+        if (m_count[i] > 0 && (best == SG_NULLMOVE
+                               || m_count[i] > m_count[best]))
+            best = i;
+    return best;
+}
+
+double RootStatistics::SecondCount() const
+{
+    const SgMove best = BestMove();
+    double second = 0;
+    for (int i = 0; i < Y_MAX_CELL; ++i)
+        if (i != best && m_count[i] > second)
+            second = m_count[i];
+    return second;
+}
+
+std::string RootStatistics::ToString(const ConstBoard& cbrd) const
+{
+    std::ostringstream os;
+    for (CellIterator i(cbrd); i; ++i)
+        if (m_count[*i] > 0)
+            os << ' ' << ConstBoard::ToString(*i) << ' ' << Mean(*i)
+               << '@' << m_count[*i];
+    return os.str();
+}
+
+//---------------------------------------------------------------------------
+
+YRootParallel::YRootParallel()
+{
+}
+
+YRootParallel::~YRootParallel()
+{
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        Stop(m_workers[i]);
+}
+
+void YRootParallel::SetNumWorkers(int n)
+{
+    while (NumWorkers() > n)
+    {
+        Stop(m_workers.back());
+        m_workers.pop_back();
+    }
+    while (NumWorkers() < n)
+    {
+        m_workers.push_back(Start(SgRandom::Global().Int(1 << 30) + 1,
+                                  m_configFile));
+        for (std::size_t i = 0; i < m_params.size(); ++i)
+            Execute(m_workers.back(), "y_param " + m_params[i].first 
+                    + ' ' + m_params[i].second);
+    }
+}
+
+void YRootParallel::SetParam(const std::string& name, 
+                             const std::string& value)
+{
+    std::size_t i = 0;
+    while (i < m_params.size() && m_params[i].first != name)
+        ++i;
+    if (i == m_params.size())
+        m_params.push_back(std::make_pair(name, value));
+    else
+        m_params[i].second = value;
+    for (std::size_t j = 0; j < m_workers.size(); ++j)
+        Execute(m_workers[j], "y_param " + name + ' ' + value);
+}
+
+/** Commands are sent to all workers before any response is read, so
+    the workers replay the game in parallel. */
+void YRootParallel::SetPosition(const Board& brd)
+{
+    std::vector<std::string> commands;
+    std::ostringstream os;
+    os << "boardsize " << brd.Size();
+    commands.push_back(os.str());
+    const Board::History& history = brd.GetHistory();
+    for (int i = 0; i < history.NumMoves(); ++i)
+    {
+        // Swap is stored with color empty; any color will do.
+        const SgBoardColor color = history.m_color[i] == SG_EMPTY
+            ? SG_WHITE : history.m_color[i];
+        commands.push_back(std::string("play ")
+                           + ConstBoard::ColorToChar(color) + ' '
+                           + ConstBoard::ToString(history.m_move[i]));
+    }
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        for (std::size_t j = 0; j < commands.size(); ++j)
+            Send(m_workers[i], commands[j]);
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        for (std::size_t j = 0; j < commands.size(); ++j)
+            Receive(m_workers[i]);
+}
+
+void YRootParallel::StartSearch(SgBlackWhite toPlay, double seconds)
+{
+    std::ostringstream os;
+    os << "uct_root_search " << ConstBoard::ColorToChar(toPlay)
+       << ' ' << seconds;
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        Send(m_workers[i], os.str());
+}
+
+void YRootParallel::Interrupt()
+{
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+        Send(m_workers[i], "# interrupt");
+}
+
+void YRootParallel::Collect(RootStatistics& stats)
+{
+    for (std::size_t i = 0; i < m_workers.size(); ++i)
+    {
+        std::istringstream is(Receive(m_workers[i]));
+        std::string move;
+        double count;
+        double mean;
+        while (is >> move >> count >> mean)
+            stats.Add(ConstBoard::FromString(move), count, mean);
+    }
+}
+
+//---------------------------------------------------------------------------
+
+/** Workers are started with --root-worker, so that a config file
+    that sets root_workers does not make them start workers of their
+    own. */
+YRootParallel::Worker YRootParallel::Start(int seed, 
+                                           const std::string& configFile)
+{
+    const std::string configArg = "--config=" + configFile;
+    int toWorker[2];
+    int fromWorker[2];
+    if (pipe(toWorker) != 0)
+        throw YException() << "pipe: " << strerror(errno);
+    if (pipe(fromWorker) != 0)
+    {
+        close(toWorker[0]);
+        close(toWorker[1]);
+        throw YException() << "pipe: " << strerror(errno);
+    }
+    // Later workers must not inherit our ends of the pipes, or a
+    // worker would not see end of input when we close them.
+    fcntl(toWorker[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fromWorker[0], F_SETFD, FD_CLOEXEC);
+    // Only async-signal-safe calls between fork and exec.
+    char seedArg[32];
+    snprintf(seedArg, sizeof(seedArg), "--seed=%d", seed);
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        const int error = errno;
+        close(toWorker[0]);
+        close(toWorker[1]);
+        close(fromWorker[0]);
+        close(fromWorker[1]);
+        throw YException() << "fork: " << strerror(error);
+    }
+    if (pid == 0)
+    {
+        dup2(toWorker[0], 0);
+        dup2(fromWorker[1], 1);
+        const int devNull = open("/dev/null", O_WRONLY);
+        if (devNull >= 0)
+        {
+            dup2(devNull, 2);
+            close(devNull);
+        }
+        close(toWorker[0]);
+        close(toWorker[1]);
+        close(fromWorker[0]);
+        close(fromWorker[1]);
+        if (configFile.empty())
+            execl("/proc/self/exe", "y", seedArg, "--root-worker",
+                  static_cast<char*>(0));
+        else
+            execl("/proc/self/exe", "y", seedArg, "--root-worker",
+                  configArg.c_str(), static_cast<char*>(0));
+        _exit(127);
+    }
+    close(toWorker[0]);
+    close(fromWorker[1]);
+    // A worker that dies should make Send() fail, not kill us.
+    signal(SIGPIPE, SIG_IGN);
+    Worker worker;
+    worker.m_pid = pid;
+    worker.m_in = fdopen(toWorker[1], "w");
+    worker.m_out = fdopen(fromWorker[0], "r");
+    return worker;
+}
+
+void YRootParallel::Stop(Worker& worker)
+{
+    try {
+        Execute(worker, "quit");
+    }
+    catch (const YException&) {
+    }
+    fclose(worker.m_in);
+    fclose(worker.m_out);
+    waitpid(worker.m_pid, 0, 0);
+}
+
+void YRootParallel::Send(Worker& worker, const std::string& command)
+{
+    if (fprintf(worker.m_in, "%s\n", command.c_str()) < 0
+        || fflush(worker.m_in) != 0)
+        throw YException() << "Worker " << worker.m_pid
+                           << ": cannot send '" << command << "'";
+}
+
+/** A GTP response is a status character, the answer, and an empty
+    line. */
+std::string YRootParallel::Receive(Worker& worker)
+{
+    std::string response;
+    char line[4096];
+    while (fgets(line, sizeof(line), worker.m_out) != 0)
+    {
+        if (line[0] == '\n' && ! response.empty())
+            break;
+        response += line;
+    }
+    if (response.empty())
+        throw YException() << "Worker " << worker.m_pid << " died";
+    if (response[0] != '=')
+        throw YException() << "Worker " << worker.m_pid << ": " << response;
+    return response.substr(1);
+}
+
+std::string YRootParallel::Execute(Worker& worker, const std::string& command)
+{
+    Send(worker, command);
+    return Receive(worker);
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgBlackWhite.h"
+#include "SgMove.h"
+
+#include "ConstBoard.h"
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+class Board;
+
+//---------------------------------------------------------------------------
+
+/** Visit counts and values of the root moves, summed over several
+    independent searches. */
+class RootStatistics
+{
+public:
+    RootStatistics();
+
+    void Clear();
+
+    /** Adds count games of a root move with the given mean value. */
+    void Add(SgMove move, double count, double mean);
+
+    double Count(SgMove move) const { return m_count[move]; }
+
+    double Mean(SgMove move) const;
+
+    /** Move with the largest total count; SG_NULLMOVE if empty. */
+    SgMove BestMove() const;
+
+    /** Count of the second most visited move. */
+    double SecondCount() const;
+
+    std::string ToString(const ConstBoard& cbrd) const;
+
+private:
+    double m_count[Y_MAX_CELL];
+
+    double m_valueSum[Y_MAX_CELL];
+};
+
+//---------------------------------------------------------------------------
+
+/** Root-parallel search over local worker processes.
+    Each worker is a copy of this program, started with fork/exec and
+    talking GTP over a pair of pipes. Workers search the position
+    independently and report their root statistics with
+    uct_root_search; the coordinator adds them up. Workers keep their
+    tree between rounds of the same position, so reported counts are
+    totals and replace the previous report. */
+class YRootParallel
+{
+public:
+    YRootParallel();
+
+    /** Stops all workers. */
+    ~YRootParallel();
+
+    int NumWorkers() const { return static_cast<int>(m_workers.size()); }
+
+    /** Starts or stops workers so that n are running. Each new worker
+        gets its own random seed, runs the config file and is sent
+        every parameter given to SetParam() so far. Throws YException
+        if a worker cannot be started. */
+    void SetNumWorkers(int n);
+
+    /** Config file run by workers at startup, with --config. */
+    void SetConfigFile(const std::string& filename) 
+    { m_configFile = filename; }
+
+    /** Sends "y_param name value" to all workers, and to the workers
+        started later. Throws YException if a worker rejects it. */
+    void SetParam(const std::string& name, const std::string& value);
+
+    /** Sends the board size and game history to all workers. */
+    void SetPosition(const Board& brd);
+
+    /** Asks every worker to search for the given time without
+        waiting for the answers. */
+    void StartSearch(SgBlackWhite toPlay, double seconds);
+
+    /** Asks every worker to end its search now, with "# interrupt".
+        The answers are still read by Collect(). */
+    void Interrupt();
+
+    /** Waits for the answers to StartSearch() and adds the root
+        statistics of every worker to stats. */
+    void Collect(RootStatistics& stats);
+
+private:
+    struct Worker
+    {
+        pid_t m_pid;
+
+        /** Commands to the worker. */
+        FILE* m_in;
+
+        /** Responses from the worker. */
+        FILE* m_out;
+    };
+
+    std::vector<Worker> m_workers;
+
+    std::string m_configFile;
+
+    /** Values of SetParam(), in the order the names were first set. */
+    std::vector<std::pair<std::string, std::string> > m_params;
+
+    static Worker Start(int seed, const std::string& configFile);
+
+    static void Stop(Worker& worker);
+
+    /** Sends a command without reading the response. */
+    static void Send(Worker& worker, const std::string& command);
+
+    /** Reads one response; throws YException on failure. */
+    static std::string Receive(Worker& worker);
+
+    static std::string Execute(Worker& worker, const std::string& command);
+};
+
+//---------------------------------------------------------------------------
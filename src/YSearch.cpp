@@ -5,6 +5,9 @@
 
 #include "YSearch.h"
 
+#include <algorithm>
+#include <cstring>
+
 //----------------------------------------------------------------------------
 
 YSearchTracer::YSearchTracer(SgNode* root, int boardHeight)
@@ -39,10 +42,26 @@ void YSearchTracer::AddMoveProp(SgNode* node, SgMove move,
 
 //----------------------------------------------------------------------------
 
+bool YSearch::OrderedMove::operator<(const OrderedMove& other) const
+{
+    if (m_tier != other.m_tier)
+        return m_tier > other.m_tier;
+    if (m_history != other.m_history)
+        return m_history > other.m_history;
+    return m_weight > other.m_weight;
+}
+
+//----------------------------------------------------------------------------
+
 YSearch::YSearch()
     : SgSearch(0),
-      m_brd(8)
+      m_brd(8),
+      m_moveOrdering(true),
+      m_endgameDb(0),
+      m_rootMoves(0),
+      m_depthLimit(0)
 {
+    m_ordered.reserve(Y_MAX_CELL);
 }
 
 YSearch::~YSearch()
@@ -65,23 +84,101 @@ void YSearch::CreateTracer()
     SetTracer(tracer);
 }
 
+/** Killers and the history table are kept over the iterations of
+    one search and cleared for the next. */
 void YSearch::OnStartSearch()
 {
+    m_rootMoves = m_brd.NumMoves();
+    for (int i = 0; i < MAX_PLY; ++i)
+        for (int j = 0; j < NUM_KILLERS; ++j)
+            m_killers[i][j] = SG_NULLMOVE;
+    memset(m_historyTable, 0, sizeof(m_historyTable));
 }
 
 void YSearch::StartOfDepth(int depthLimit)
 {
     SgSearch::StartOfDepth(depthLimit);
     std::cerr << "Depth=" << depthLimit << std::endl;
+    m_depthLimit = depthLimit;
+    ClearFrame(0);
+}
+
+void YSearch::ClearFrame(int ply)
+{
+    m_frames[ply].m_numMoves = -1;
+    m_frames[ply].m_numTried = 0;
+    m_frames[ply].m_lastMove = SG_NULLMOVE;
 }
 
 void YSearch::Generate(SgVector<SgMove>* moves, int depth)
 {
     SG_UNUSED(depth);
     moves->Clear();
+    Board::SymmetryList symmetries;
+    m_brd.GetSymmetries(symmetries);
+    MarkedCells mustplay;
+    const bool restricted = m_brd.ComputeMustplay(m_toPlay, mustplay);
     for (CellIterator it(m_brd); it; ++it)
-        if (m_brd.IsEmpty(*it))
+        if (m_brd.IsEmpty(*it)
+            && (! restricted || mustplay.Marked(*it))
+            && m_brd.IsSymmetryRepresentative(*it, symmetries, 
+                                             restricted ? &mustplay : 0))
             moves->PushBack(*it);
+    // Every move loses; one of them is enough to show it.
+    if (restricted && mustplay.Count() == 0)
+        for (CellIterator it(m_brd); it && moves->IsEmpty(); ++it)
+            if (m_brd.IsEmpty(*it))
+                moves->PushBack(*it);
+    const int ply = Ply();
+    m_frames[ply].m_numMoves = moves->Length();
+    if (m_moveOrdering)
+        OrderMoves(moves, ply);
+}
+
+/** Win threats of either player come first, then replies that save a
+    bridge broken by the last move, then the killers of this ply; each
+    of these groups and the remaining moves are sorted by the history
+    table and then by weight. */
+void YSearch::OrderMoves(SgVector<SgMove>* moves, int ply)
+{
+    m_localMoves.Clear();
+    m_brd.GeneralSaveBridge(m_localMoves);
+    const int* history = m_historyTable[m_toPlay];
+    m_ordered.clear();
+    for (int i = 0; i < moves->Length(); ++i)
+    {
+        const SgMove move = (*moves)[i];
+        const cell_t p = static_cast<cell_t>(move);
+        OrderedMove m;
+        m.m_move = move;
+        m.m_weight = m_brd.WeightCell(p);
+        m.m_history = history[p];
+        if (m.m_weight >= LocalMoves::WEIGHT_WIN_THREAT 
+            || m_brd.IsCellThreat(p))
+            m.m_tier = 3;
+        else if (m_localMoves.slot[p] >= 0)
+            m.m_tier = 2;
+        else if (move == m_killers[ply][0] || move == m_killers[ply][1])
+            m.m_tier = 1;
+        else
+            m.m_tier = 0;
+        m_ordered.push_back(m);
+    }
+    std::sort(m_ordered.begin(), m_ordered.end());
+    moves->Clear();
+    for (std::size_t i = 0; i < m_ordered.size(); ++i)
+        moves->PushBack(m_ordered[i].m_move);
+}
+
+void YSearch::RecordCutoff(int ply, SgBlackWhite color, SgMove move)
+{
+    if (m_killers[ply][0] != move)
+    {
+        m_killers[ply][1] = m_killers[ply][0];
+        m_killers[ply][0] = move;
+    }
+    const int remaining = std::max(1, m_depthLimit - ply);
+    m_historyTable[color][move] += remaining * remaining;
 }
 
 int YSearch::Evaluate(bool* isExact, int depth)
@@ -92,6 +189,8 @@ int YSearch::Evaluate(bool* isExact, int depth)
         type = m_brd.GetVCWinner();
     else if (m_brd.IsGameOver())
         type = m_brd.GetWinner();
+    else if (m_endgameDb != 0 && Ply() > 0)
+        type = m_endgameDb->Lookup(m_brd, m_toPlay);
     switch(type)
     {
     case SG_EMPTY:
@@ -118,8 +217,12 @@ bool YSearch::Execute(SgMove move, int* delta, int depth)
     SG_UNUSED(depth);
     *delta = DEPTH_UNIT;
     int cell = static_cast<int>(move);
+    const int ply = Ply();
+    ++m_frames[ply].m_numTried;
+    m_frames[ply].m_lastMove = move;
     m_brd.Play(m_toPlay, cell);
     m_toPlay = SgOppBW(m_toPlay);
+    ClearFrame(ply + 1);
     return true;
 }
 
@@ -127,6 +230,11 @@ void YSearch::TakeBack()
 {
     m_brd.Undo();
     m_toPlay = SgOppBW(m_toPlay);
+    const Frame& child = m_frames[Ply() + 1];
+    if (   child.m_numTried > 0 
+        && (child.m_numMoves < 0 || child.m_numTried < child.m_numMoves)
+        && ! AbortSearch())
+        RecordCutoff(Ply() + 1, SgOppBW(m_toPlay), child.m_lastMove);
 }
 
 //----------------------------------------------------------------------------
@@ -10,6 +10,7 @@
 #include "SgSearch.h"
 #include "SgHashTable.h"
 #include "Board.h"
+#include "YEndgameDb.h"
 
 //----------------------------------------------------------------------------
 
@@ -68,14 +69,91 @@ public:
 
     virtual bool EndOfGame() const;
 
+    /** Order moves by win threats, bridge saves, killers, the history
+        table and Board::WeightCell(). Without it moves are generated
+        in cell order. */
+    bool MoveOrdering() const    { return m_moveOrdering; }
+    void SetMoveOrdering(bool f) { m_moveOrdering = f; }
+
+    /** Positions in the database are ends of the game with an exact
+        value, except the root, which is searched to find a winning
+        move. 0 for none. */
+    void SetEndgameDb(const YEndgameDb* db) { m_endgameDb = db; }
+
 private:
+    /** Plies from the root; games cannot be longer. */
+    static const int MAX_PLY = Y_MAX_CELL + 1;
+
+    static const int NUM_KILLERS = 2;
+
+    /** Moves tried at a node of the current line. A node that is left
+        before all generated moves were tried had a cutoff, caused by
+        the last move tried. SgSearch does not report cutoffs, so they
+        are found this way. */
+    struct Frame
+    {
+        /** -1 until Generate() is called: SgSearch tries the hash
+            move first. */
+        int m_numMoves;
+
+        int m_numTried;
+
+        SgMove m_lastMove;
+    };
+
+    struct OrderedMove
+    {
+        int m_tier;
+
+        int m_history;
+
+        float m_weight;
+
+        SgMove m_move;
+
+        bool operator<(const OrderedMove& other) const;
+    };
+
     SgBlackWhite m_toPlay;
 
     Board m_brd;
 
-    std::vector<int> m_history;
+    bool m_moveOrdering;
+
+    const YEndgameDb* m_endgameDb;
+
+    /** Moves at the root of the search. */
+    int m_rootMoves;
+
+    int m_depthLimit;
+
+    Frame m_frames[MAX_PLY + 1];
+
+    SgMove m_killers[MAX_PLY][NUM_KILLERS];
+
+    /** Sum of squared remaining depths of the cutoffs caused by each
+        move, by the player making it. */
+    int m_historyTable[2][Y_MAX_CELL];
+
+    LocalMoves m_localMoves;
+
+    /** Scratch space for Generate(). */
+    std::vector<OrderedMove> m_ordered;
+
+    int Ply() const;
+
+    void ClearFrame(int ply);
+
+    void OrderMoves(SgVector<SgMove>* moves, int ply);
+
+    void RecordCutoff(int ply, SgBlackWhite color, SgMove move);
 };
 
+inline int YSearch::Ply() const
+{
+    return m_brd.NumMoves() - m_rootMoves;
+}
+
 inline void YSearch::SetToPlay(SgBlackWhite toPlay)
 {
     m_toPlay = toPlay;
@@ -98,7 +176,9 @@ inline SgHashCode YSearch::GetHashCode() const
 
 inline bool YSearch::EndOfGame() const
 {
-    return m_brd.HasWinningVC() || m_brd.IsGameOver();
+    return m_brd.HasWinningVC() || m_brd.IsGameOver()
+        || (m_endgameDb != 0 && Ply() > 0
+            && m_endgameDb->Lookup(m_brd, m_toPlay) != SG_EMPTY);
 }
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,124 @@
+#include "SgSystem.h"
+
+#include "YSearchReporter.h"
+#include "ConstBoard.h"
+
+#include <iostream>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/thread/thread_time.hpp>
+
+//---------------------------------------------------------------------------
+
+YSearchReporter::YSearchReporter()
+    : m_cbrd(0),
+      m_liveGfx(false),
+      m_progress(false),
+      m_interval(1.0),
+      m_stop(false),
+      m_hasSnapshot(false),
+      m_wantsSnapshot(false)
+{
+}
+
+YSearchReporter::~YSearchReporter()
+{
+    if (IsRunning())
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+        m_thread->join();
+    }
+}
+
+void YSearchReporter::Start(const ConstBoard& cbrd, bool liveGfx,
+                            bool progress, double interval)
+{
+    SG_ASSERT(! IsRunning());
+    m_cbrd = &cbrd;
+    m_liveGfx = liveGfx;
+    m_progress = progress;
+    m_interval = interval;
+    m_stop = false;
+    m_hasSnapshot = false;
+    m_wantsSnapshot = false;
+    m_thread.reset(new boost::thread(boost::bind(&YSearchReporter::Run,
+                                                 this)));
+}
+
+void YSearchReporter::Stop(const YUctSearchUtil::Snapshot& last)
+{
+    SG_ASSERT(IsRunning());
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread->join();
+    m_thread.reset();
+    m_wantsSnapshot = false;
+    Report(last);
+}
+
+void YSearchReporter::Publish(const YUctSearchUtil::Snapshot& snapshot)
+{
+    boost::mutex::scoped_try_lock lock(m_mutex);
+    if (! lock.owns_lock())
+        return;
+    m_snapshot = snapshot;
+    m_hasSnapshot = true;
+    m_wantsSnapshot = false;
+    m_condition.notify_all();
+}
+
+void YSearchReporter::Run()
+{
+    YUctSearchUtil::Snapshot snapshot;
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (;;)
+    {
+        const boost::system_time deadline = boost::get_system_time()
+            + boost::posix_time::milliseconds(
+                                   static_cast<long>(m_interval * 1000));
+        while (! m_stop && m_condition.timed_wait(lock, deadline))
+            ;
+        if (m_stop)
+            break;
+        m_wantsSnapshot = true;
+        while (! m_stop && ! m_hasSnapshot)
+            m_condition.wait(lock);
+        if (m_stop)
+            break;
+        snapshot = m_snapshot;
+        m_hasSnapshot = false;
+        lock.unlock();
+        Report(snapshot);
+        lock.lock();
+    }
+}
+
+void YSearchReporter::Report(const YUctSearchUtil::Snapshot& snapshot) const
+{
+    if (m_liveGfx)
+    {
+        std::ostringstream os;
+        os << "gogui-gfx:\n";
+        os << "uct\n";
+        YUctSearchUtil::GoGuiGfx(snapshot, *m_cbrd, os);
+        os << '\n';
+        std::cout << os.str();
+        std::cout.flush();
+    }
+    if (m_progress)
+    {
+        std::ostringstream os;
+        YUctSearchUtil::WriteProgress(snapshot, *m_cbrd, os);
+        std::cerr << os.str();
+        std::cerr.flush();
+    }
+}
+
+//---------------------------------------------------------------------------
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "SgSystem.h"
+
+#include "YUctSearchUtil.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+class ConstBoard;
+
+//---------------------------------------------------------------------------
+
+/** Reports the progress of a search from its own thread.
+    Every interval the reporter asks for a snapshot of the root
+    statistics; search thread 0 polls WantsSnapshot() and hands one
+    over with Publish(), which never waits for the reporter. The
+    reporter then writes GoGui live graphics to std::cout and/or one
+    line of JSON per snapshot (see YUctSearchUtil::WriteProgress()) to
+    std::cerr, while the search goes on. */
+class YSearchReporter
+{
+public:
+    YSearchReporter();
+
+    ~YSearchReporter();
+
+    /** Starts the reporter thread. cbrd must stay valid until
+        Stop(). */
+    void Start(const ConstBoard& cbrd, bool liveGfx, bool progress,
+               double interval);
+
+    /** Stops the reporter thread and reports the final snapshot from
+        the calling thread. */
+    void Stop(const YUctSearchUtil::Snapshot& last);
+
+    bool IsRunning() const { return m_thread.get() != 0; }
+
+    /** Cheap enough to poll on every game. */
+    bool WantsSnapshot() const { return m_wantsSnapshot; }
+
+    /** Copies snapshot for the reporter. Returns without copying if
+        the reporter holds the lock; it will ask again. */
+    void Publish(const YUctSearchUtil::Snapshot& snapshot);
+
+private:
+    const ConstBoard* m_cbrd;
+
+    bool m_liveGfx;
+
+    bool m_progress;
+
+    double m_interval;
+
+    boost::mutex m_mutex;
+
+    boost::condition_variable m_condition;
+
+    boost::scoped_ptr<boost::thread> m_thread;
+
+    /** Protected by m_mutex. */
+    bool m_stop;
+
+    /** Protected by m_mutex. */
+    bool m_hasSnapshot;
+
+    /** Set by the reporter thread, cleared by Publish(). */
+    volatile bool m_wantsSnapshot;
+
+    /** Protected by m_mutex. */
+    YUctSearchUtil::Snapshot m_snapshot;
+
+    void Run();
+
+    void Report(const YUctSearchUtil::Snapshot& snapshot) const;
+};
+
+//---------------------------------------------------------------------------
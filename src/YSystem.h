@@ -7,6 +7,17 @@
 
 std::ostream& YTrace();
 
+/** Expands to its argument only if statistics are compiled in
+    (configure --enable-statistics). */
+#ifdef Y_STATISTICS
+#define Y_STAT(x) x
+#else
+#define Y_STAT(x)
+#endif
+
+/** Size used to pad data written by different threads. */
+static const int Y_CACHE_LINE_SIZE = 64;
+
 namespace YSystem
 {
     void Init(int tracing_level);
@@ -0,0 +1,63 @@
+#include "SgSystem.h"
+
+#include "YTranspositionTable.h"
+
+#include <algorithm>
+
+//---------------------------------------------------------------------------
+
+YTranspositionTable::YTranspositionTable(int bits)
+    : m_entries(std::size_t(1) << bits),
+      m_mask((std::size_t(1) << bits) - 1)
+{
+    Clear();
+}
+
+void YTranspositionTable::Clear()
+{
+    for (std::size_t i = 0; i < m_entries.size(); ++i)
+    {
+        m_entries[i].m_hash.Clear();
+        m_entries[i].m_toPlay = SG_BLACK;
+        m_entries[i].m_count = 0.0f;
+        m_entries[i].m_valueSum = 0.0f;
+    }
+}
+
+bool YTranspositionTable::Lookup(const SgHashCode& hash, SgBlackWhite toPlay,
+                                 SgUctValue& value, SgUctValue& count) const
+{
+    const Entry& entry = m_entries[Index(hash, toPlay)];
+    if (entry.m_hash != hash || entry.m_toPlay != toPlay)
+        return false;
+    const float n = entry.m_count;
+    const float sum = entry.m_valueSum;
+    if (n < 1.0f || entry.m_hash != hash)
+        return false;
+    count = n;
+    value = std::min(1.0f, std::max(0.0f, sum / n));
+    return true;
+}
+
+void YTranspositionTable::Add(const SgHashCode& hash, SgBlackWhite toPlay,
+                              SgUctValue value)
+{
+    Entry& entry = m_entries[Index(hash, toPlay)];
+    if (entry.m_hash != hash || entry.m_toPlay != toPlay)
+    {
+        if (entry.m_count > 1.0f)
+        {
+            entry.m_valueSum -= entry.m_valueSum / entry.m_count;
+            entry.m_count -= 1.0f;
+            return;
+        }
+        entry.m_hash = hash;
+        entry.m_toPlay = toPlay;
+        entry.m_count = 0.0f;
+        entry.m_valueSum = 0.0f;
+    }
+    entry.m_count += 1.0f;
+    entry.m_valueSum += static_cast<float>(value);
+}
+
+//---------------------------------------------------------------------------
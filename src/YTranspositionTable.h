@@ -0,0 +1,65 @@
+#pragma once
+
+#include "SgSystem.h"
+#include "SgBlackWhite.h"
+#include "SgHash.h"
+#include "SgUctValue.h"
+
+#include <vector>
+
+//---------------------------------------------------------------------------
+
+/** Game results of positions reached in the UCT tree, shared by all
+    threads and by all tree nodes that reach the same position through
+    different move orders.
+    Entries are indexed by hash code and player to move. On a
+    collision the old entry loses one game per update and is replaced
+    once it is empty, so frequently visited positions stay.
+    Like SgUctSearch in lock-free mode, updates are not synchronized:
+    a lost update or a torn read only adds a little noise, and the key
+    is checked again after the statistics are read. */
+class YTranspositionTable
+{
+public:
+    /** Creates a table with 2^bits entries. */
+    YTranspositionTable(int bits);
+
+    void Clear();
+
+    /** Returns false if the position is not in the table. The value is
+        for the player who made the last move, as in SgUctMoveInfo. */
+    bool Lookup(const SgHashCode& hash, SgBlackWhite toPlay,
+                SgUctValue& value, SgUctValue& count) const;
+
+    /** Adds a game result; value is for the player who made the last
+        move. */
+    void Add(const SgHashCode& hash, SgBlackWhite toPlay, SgUctValue value);
+
+    std::size_t NumEntries() const { return m_entries.size(); }
+
+private:
+    struct Entry
+    {
+        SgHashCode m_hash;
+
+        SgBlackWhite m_toPlay;
+
+        float m_count;
+
+        float m_valueSum;
+    };
+
+    std::vector<Entry> m_entries;
+
+    std::size_t m_mask;
+
+    std::size_t Index(const SgHashCode& hash, SgBlackWhite toPlay) const;
+};
+
+inline std::size_t YTranspositionTable::Index(const SgHashCode& hash,
+                                              SgBlackWhite toPlay) const
+{
+    return (hash.Code1() ^ (toPlay == SG_WHITE ? 0x9e3779b9u : 0u)) & m_mask;
+}
+
+//---------------------------------------------------------------------------
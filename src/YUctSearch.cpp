@@ -8,10 +8,27 @@
 #include "YUctSearch.h"
 #include "YUctSearchUtil.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 //----------------------------------------------------------------------------
 
 namespace {
 
+/** log2 of the number of transposition table entries. */
+const int TRANSPOSITION_TABLE_BITS = 20;
+
+/** log2 of the number of entries of the leaf solvers' table. */
+const int LEAF_SOLVER_TABLE_BITS = 18;
+
+/** Games between two checks of the tree size and early stop. */
+const SgUctValue CHECK_INTERVAL = 256;
+
+/** Games the best move needs before its win rate can stop the
+    search. */
+const SgUctValue EARLY_STOP_MIN_COUNT = 500;
+
 template<typename T>
 void ShuffleVector(std::vector<T>& v, SgRandom& random)
 {
@@ -44,9 +61,15 @@ YUctThreadState::YUctThreadState(const YUctSearch& search,
                                    const unsigned int threadId)
     : SgUctThreadState(threadId, Y_MAX_CELL + 1),
       m_search(search),
-      m_brd(search.GetBoard().Size())
+      m_brd(search.GetBoard().Size()),
+      m_inLightPlayout(false),
+      m_inLockstep(false),
+      m_numPlayoutMoves(0),
+      m_endgameWinner(SG_EMPTY),
+      m_leafSolver(search.LeafSolverTable())
 {
     m_weights = new WeightedRandom[2];
+    m_brd.SetStatistics(&m_stats.m_board);
 }
 
 YUctThreadState::~YUctThreadState()
@@ -58,11 +81,16 @@ void YUctThreadState::StartSearch()
 {
     m_brd.SetPosition(m_search.GetBoard());
     m_brd.SetSavePoint1();
+    m_leafSolver.SetEndgameDb(m_search.EndgameDb());
+    m_leafSolver.SetMaxNodes(m_search.LeafSolveNodes());
 }
 
 void YUctThreadState::GameStart()
 {
     m_brd.RestoreSavePoint1();
+    m_inLightPlayout = false;
+    m_inLockstep = false;
+    m_treePositions.clear();
 }
 
 
@@ -96,22 +124,180 @@ bool YUctThreadState::GenerateAllMoves(SgUctValue count,
             provenType = SG_PROVEN_LOSS;
         return false;
     }
+    if (m_search.EndgameDb() != 0 && ! IsRoot())
+    {
+        const SgBoardColor winner 
+            = m_search.EndgameDb()->Lookup(m_brd, m_brd.ToPlay());
+        if (winner != SG_EMPTY)
+        {
+            provenType = (winner == m_brd.ToPlay()) 
+                ? SG_PROVEN_WIN : SG_PROVEN_LOSS;
+            return false;
+        }
+    }
     SG_UNUSED(count);
+    MarkedCells mustplay;
+    bool restricted = m_search.UseMustplay()
+        && m_brd.ComputeMustplay(m_brd.ToPlay(), mustplay);
+    if (restricted && mustplay.Count() == 0)
+    {
+        // Every move loses, but the root needs moves to choose from.
+        if (IsRoot())
+            restricted = false;
+        else
+        {
+            provenType = SG_PROVEN_LOSS;
+            return false;
+        }
+    }
+    if (WantsLeafSolve(restricted, mustplay))
+    {
+        provenType = SolveLeaf();
+        if (provenType != SG_NOT_PROVEN)
+            return false;
+    }
+    Board::SymmetryList symmetries;
+    if (m_search.UseSymmetryPruning())
+        m_brd.GetSymmetries(symmetries);
     for (Board::EmptyIterator it(m_brd); it; ++it) {
-        // TODO: Include only mustplay!
-        if (!m_brd.IsCellMarkedDead(*it))
+        if (!m_brd.IsCellMarkedDead(*it)
+            && (!restricted || mustplay.Marked(*it))
+            && m_brd.IsSymmetryRepresentative(*it, symmetries, 
+                                              restricted ? &mustplay : 0))
             moves.push_back(*it);
     }
+    ComputePriors(moves);
+    if (m_search.Transpositions() != 0)
+        ApplyTranspositions(moves);
+    if (m_search.RootSeed() != 0 && IsRoot())
+        ApplyRootSeed(moves);
     provenType = SG_NOT_PROVEN;
     return false;
 }
 
+/** A proven root would have no children to choose a move from, so
+    positions are proven without expanding them only below the root. */
+bool YUctThreadState::IsRoot() const
+{
+    return m_brd.NumMoves() == m_search.GetBoard().NumMoves();
+}
+
+bool YUctThreadState::WantsLeafSolve(bool restricted,
+                                     const MarkedCells& mustplay) const
+{
+    if (IsRoot())
+        return false;
+    const int numEmpty = m_brd.GetAllEmptyCells().Size();
+    return (m_search.LeafSolveEmpty() > 0
+            && numEmpty <= m_search.LeafSolveEmpty())
+        || (restricted && m_search.LeafSolveMustplay() > 0
+            && static_cast<int>(mustplay.Count())
+               <= m_search.LeafSolveMustplay());
+}
+
+/** Leaves the solver cannot finish within its node budget are tried
+    again when they are expanded again; the shared table keeps the
+    work of earlier tries. */
+SgUctProvenType YUctThreadState::SolveLeaf()
+{
+    Y_STAT(m_stats.m_playout.m_leafSolves++;)
+    const SgBlackWhite toPlay = m_brd.ToPlay();
+    SgMove move;
+    const SgBoardColor winner = m_leafSolver.Solve(m_brd, toPlay,
+                                    std::numeric_limits<double>::max(), move);
+    if (winner == SG_EMPTY)
+        return SG_NOT_PROVEN;
+    Y_STAT(m_stats.m_playout.m_leafSolved++;)
+    return winner == toPlay ? SG_PROVEN_WIN : SG_PROVEN_LOSS;
+}
+
+/** The prior of a move is w / (w + g), where w is its weight and g is
+    the geometric mean of the weights of all moves: the average move
+    gets 0.5 and win threats and bridge saves get close to 1. */
+void YUctThreadState::ComputePriors(std::vector<SgUctMoveInfo>& moves)
+{
+    const SgUctValue count = m_search.PriorCount();
+    const SgUctValue raveCount = m_search.ProgressiveBias();
+    if (moves.empty() || (count <= 0 && raveCount <= 0))
+        return;
+    m_localMoves.Clear();
+    if (m_search.UseSaveBridge())
+        m_brd.GeneralSaveBridge(m_localMoves);
+    m_priorLogWeights.resize(moves.size());
+    float logMean = 0.0f;
+    for (std::size_t i = 0; i < moves.size(); ++i)
+    {
+        const cell_t p = static_cast<cell_t>(moves[i].m_move);
+        float w = m_brd.WeightCell(p);
+        if (m_localMoves.slot[p] >= 0)
+            w += m_localMoves.gamma[m_localMoves.slot[p]];
+        m_priorLogWeights[i] = std::log(w);
+        logMean += m_priorLogWeights[i];
+    }
+    logMean /= static_cast<float>(moves.size());
+    for (std::size_t i = 0; i < moves.size(); ++i)
+    {
+        const SgUctValue value 
+            = 1.0 / (1.0 + std::exp(logMean - m_priorLogWeights[i]));
+        if (count > 0)
+        {
+            moves[i].m_value = value;
+            moves[i].m_count = count;
+        }
+        if (raveCount > 0)
+        {
+            moves[i].m_raveValue = value;
+            moves[i].m_raveCount = raveCount;
+        }
+    }
+}
+
+void YUctThreadState::ApplyTranspositions(std::vector<SgUctMoveInfo>& moves)
+{
+    const YTranspositionTable& table = *m_search.Transpositions();
+    const SgBlackWhite toPlay = m_brd.ToPlay();
+    for (std::size_t i = 0; i < moves.size(); ++i)
+    {
+        SgUctValue value;
+        SgUctValue count;
+        const cell_t p = static_cast<cell_t>(moves[i].m_move);
+        if (table.Lookup(m_brd.HashAfterMove(p, toPlay), SgOppBW(toPlay),
+                         value, count))
+        {
+            moves[i].m_value = value;
+            moves[i].m_count = count;
+            Y_STAT(m_stats.m_playout.m_transpositionHits++;)
+        }
+    }
+}
+
+void YUctThreadState::ApplyRootSeed(std::vector<SgUctMoveInfo>& moves)
+{
+    const YAnalysisCache::Entry& seed = *m_search.RootSeed();
+    for (std::size_t i = 0; i < moves.size(); ++i)
+        for (int j = 0; j < seed.m_numChildren; ++j)
+            if (seed.m_children[j].m_move == moves[i].m_move)
+            {
+                moves[i].m_value = seed.m_children[j].m_value;
+                moves[i].m_count 
+                    = YAnalysisCache::SeedCount(seed.m_children[j]);
+                break;
+            }
+}
+
 void YUctThreadState::Execute(SgMove move)
 {
     // YTrace() << m_brd.ToString() << '\n'
     //           << "move=" << m_brd.ToString(move) << '\n';
     m_brd.Play(m_brd.ToPlay(), move);
     //m_brd.GroupExpand(move);
+    if (m_search.Transpositions() != 0)
+    {
+        TreePosition pos;
+        pos.m_hash = m_brd.Hash();
+        pos.m_toPlay = m_brd.ToPlay();
+        m_treePositions.push_back(pos);
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -119,64 +305,114 @@ void YUctThreadState::Execute(SgMove move)
 
 SgUctValue YUctThreadState::Evaluate()
 {
-    SG_ASSERT(m_brd.IsGameOver());
-    return m_brd.IsWinner(m_brd.ToPlay()) ? 1.0 : 0.0;
+    SgBlackWhite toPlay;
+    const SgUctValue value = EvaluatePlayout(toPlay);
+    if (m_search.Transpositions() != 0)
+        UpdateTranspositions(toPlay == SG_BLACK ? value : 1.0 - value);
+    return value;
 }
 
-SgMove YUctThreadState::GenerateLocalMove()
+/** Returns the result for the player to move at the end of the
+    playout, which is stored in toPlay. */
+SgUctValue YUctThreadState::EvaluatePlayout(SgBlackWhite& toPlay)
 {
-    SgMove move = SG_NULLMOVE;
-    if (m_search.UseSaveBridge()) 
+    if (m_endgameWinner != SG_EMPTY)
     {
-        m_localMoves.Clear();
-        
-        m_brd.GeneralSaveBridge(m_localMoves);
-
-        float random = m_random.Float(m_weights[m_brd.ToPlay()].Total() + 
-                                      m_localMoves.Total());
-        if (random < m_localMoves.Total())
-        {
-            move = m_localMoves.Choose(random);
-            YUctSearch::PlayoutStatistics::Get().m_localMoves++;
-        }
-    } 
-    return move;
+        toPlay = m_brd.ToPlay();
+        return m_endgameWinner == toPlay ? 1.0 : 0.0;
+    }
+    if (m_inLockstep)
+    {
+        Y_STAT(m_stats.m_playout.m_lockstepGames += m_lockstep.NumLanes();)
+        toPlay = m_light.ToPlay();
+        const SgUctValue black = m_lockstep.Run(m_light, m_random);
+        return toPlay == SG_BLACK ? black : 1.0 - black;
+    }
+    if (m_inLightPlayout)
+    {
+        SG_ASSERT(m_light.IsGameOver());
+        toPlay = m_light.ToPlay();
+        return m_light.IsWinner(toPlay) ? 1.0 : 0.0;
+    }
+    toPlay = m_brd.ToPlay();
+    if (m_brd.IsGameOver())
+        return m_brd.IsWinner(toPlay) ? 1.0 : 0.0;
+    SG_ASSERT(m_search.UseVCTermination() && m_brd.HasWinningVC());
+    return m_brd.IsVCWinner(toPlay) ? 1.0 : 0.0;
 }
 
-SgMove YUctThreadState::GenerateGlobalMove()
+void YUctThreadState::UpdateTranspositions(SgUctValue blackValue)
 {
-    SgMove move = SG_NULLMOVE;
-
-    // m_weights[toPlay].Build();
-    // move = m_weights[toPlay].Choose(m_random);
-    move = m_weights[m_brd.ToPlay()].ChooseLinear(m_random);
-    //YTrace() << "global move = " << m_brd.ToString(move) << '\n';
-    YUctSearch::PlayoutStatistics::Get().m_globalMoves++;
+    YTranspositionTable& table = *m_search.Transpositions();
+    for (std::size_t i = 0; i < m_treePositions.size(); ++i)
+    {
+        const TreePosition& pos = m_treePositions[i];
+        // Values are for the player who made the last move.
+        table.Add(pos.m_hash, pos.m_toPlay, 
+                  pos.m_toPlay == SG_WHITE ? blackValue : 1.0 - blackValue);
+    }
+}
 
-    if (!m_brd.IsEmpty(move)) {
-        //throw BenzeneException() << "Weighted move not empty!\n";
-        YTrace() << "Weighted move not empty!\n";
-        abort();
+SgMove YUctThreadState::GenerateLightPlayoutMove()
+{
+    if (m_light.IsGameOver())
+        return SG_NULLMOVE;
+    SG_ASSERT(m_light.NumEmpty() > 0);
+    Y_STAT(m_stats.m_playout.m_totalMoves++;)
+    Y_STAT(m_stats.m_playout.m_lightMoves++;)
+    if (m_search.UseSaveBridge())
+    {
+        const cell_t reply = m_light.SaveBridge(m_random);
+        if (reply != SG_NULLMOVE)
+            return reply;
     }
-    return move;
+    return m_light.RandomEmpty(m_random);
 }
 
 SgMove YUctThreadState::GeneratePlayoutMove(bool& skipRaveUpdate)
 {
     skipRaveUpdate = false;
+    if (m_inLockstep || m_endgameWinner != SG_EMPTY)
+        return SG_NULLMOVE;
+    if (m_inLightPlayout)
+        return GenerateLightPlayoutMove();
     //m_brd.CheckConsistency();
-    if (m_weights[m_brd.ToPlay()].Total() < 0.0001)
+    const WeightedRandom& global = m_weights[m_brd.ToPlay()];
+    if (global.Total() < 0.0001)
         return SG_NULLMOVE;
     if (m_brd.IsGameOver())
         return SG_NULLMOVE;
+    if (m_search.UseVCTermination() && m_brd.HasWinningVC())
+    {
+        Y_STAT(m_stats.m_playout.m_vcTerminations++;)
+        return SG_NULLMOVE;
+    }
+
+    Y_STAT(m_stats.m_playout.m_totalMoves++;)
 
-    YUctSearch::PlayoutStatistics::Get().m_totalMoves++;
-    SgMove move = SG_NULLMOVE;
+    m_localMoves.Clear();
+    if (m_search.UseSaveBridge())
+        m_brd.GeneralSaveBridge(m_localMoves);
 
-    move = GenerateLocalMove();
-    if (move == SG_NULLMOVE)
+    // A single draw over local and global weights: values below the
+    // local total pick a local move, the rest fall through to the
+    // global distribution.
+    const float localTotal = m_localMoves.Total();
+    const float random = m_random.Float(localTotal + global.Total());
+    if (random < localTotal)
     {
-        move = GenerateGlobalMove();
+        Y_STAT(m_stats.m_playout.m_localMoves++;)
+        return m_localMoves.Choose(random);
+    }
+
+    SgMove move = global.ChooseLinear(random - localTotal);
+    //YTrace() << "global move = " << m_brd.ToString(move) << '\n';
+    Y_STAT(m_stats.m_playout.m_globalMoves++;)
+
+    if (move == SG_NULLMOVE || !m_brd.IsEmpty(move)) {
+        //throw BenzeneException() << "Weighted move not empty!\n";
+        YTrace() << "Weighted move not empty!\n";
+        abort();
     }
     // YTrace() << m_brd.ToString() << '\n'
     //           << "Move: " << m_brd.ToString(move) 
@@ -186,14 +422,24 @@ SgMove YUctThreadState::GeneratePlayoutMove(bool& skipRaveUpdate)
 
 void YUctThreadState::ExecutePlayout(SgMove move)
 {
+    if (m_inLightPlayout)
+    {
+        m_light.Play(move);
+        return;
+    }
     // YTrace() << m_brd.ToString() << '\n'
     //           << "move=" << m_brd.ToString(move) << '\n';
     m_brd.Play(m_brd.ToPlay(), move);
+    if (++m_numPlayoutMoves == m_search.LightPlayoutAfter())
+    {
+        SwitchToLightPlayout();
+        return;
+    }
     m_weights[SG_BLACK].SetWeight(move, 0.0f);
     m_weights[SG_WHITE].SetWeight(move, 0.0f);
 
     const MarkedCellsWithList& dirty = m_brd.GetAllDirtyWeightCells();
-    Board::Statistics::Get().m_numDirtyCellsPerMove += dirty.m_list.Length();
+    Y_STAT(m_stats.m_board.m_numDirtyCellsPerMove += dirty.m_list.Length();)
 
     // MarkedCellsWithList threatInter, threatUnion;
     // m_brd.MarkAllThreats(dirty, threatInter, threatUnion);
@@ -230,9 +476,40 @@ void YUctThreadState::TakeBackPlayout(std::size_t nuMoves)
 //---------------------------------------------------------------------------
 
 
+void YUctThreadState::SwitchToLightPlayout()
+{
+    m_light.SetPosition(m_brd);
+    m_inLightPlayout = true;
+}
+
 void YUctThreadState::StartPlayouts()
 {
-    InitializeWeights();
+    m_numPlayoutMoves = 0;
+    m_inLightPlayout = false;
+    m_inLockstep = false;
+    m_endgameWinner = SG_EMPTY;
+    if (m_search.EndgameDb() != 0 && !m_brd.IsGameOver()
+        && !m_brd.HasWinningVC())
+    {
+        m_endgameWinner = m_search.EndgameDb()->Lookup(m_brd, m_brd.ToPlay());
+        if (m_endgameWinner != SG_EMPTY)
+            return;
+    }
+    if (m_search.LockstepLanes() > 0 && !m_brd.IsGameOver()
+        && !(m_search.UseVCTermination() && m_brd.HasWinningVC()))
+    {
+        // All games are played inside Evaluate(); there are no
+        // playout moves.
+        m_light.SetPosition(m_brd);
+        if (m_lockstep.NumLanes() != m_search.LockstepLanes())
+            m_lockstep.SetNumLanes(m_search.LockstepLanes());
+        m_inLockstep = true;
+        return;
+    }
+    if (m_search.LightPlayoutAfter() == 0)
+        SwitchToLightPlayout();
+    else
+        InitializeWeights();
 
     if (m_search.NumberPlayouts() > 1) {
         m_brd.SetSavePoint2();
@@ -274,13 +551,19 @@ void YUctThreadState::ComputeWeight(cell_t p)
     }
 }
 
+void YUctThreadState::ClearStatistics()
+{
+    m_stats.m_playout.Clear();
+    m_stats.m_board.Clear();
+}
+
 void YUctThreadState::GetWeightsForLastMove
 (std::vector<float>& weights, SgBlackWhite toPlay) const
 {
     weights.assign(Y_MAX_CELL, 0.0f);
     for (CellIterator i(m_brd.Const()); i; ++i)
         weights[*i] = m_weights[toPlay][*i];
-    for (size_t i = 0; i < m_localMoves.move.size(); ++i)
+    for (int i = 0; i < m_localMoves.Length(); ++i)
         weights[ m_localMoves.move[i] ] += m_localMoves.gamma[i];
 }
 
@@ -291,6 +574,33 @@ YUctSearch::YUctSearch(YUctThreadStateFactory* threadStateFactory)
     , m_brd(13)
     , m_useSaveBridge(true)
     , m_liveGfx(false)
+    , m_useVCTermination(true)
+    , m_lightPlayoutAfter(-1)
+    , m_lockstepLanes(0)
+    , m_priorCount(10)
+    , m_progressiveBias(0)
+    , m_progressStream(false)
+    , m_reportInterval(1.0)
+    , m_earlyStop(true)
+    , m_earlyStopWinRate(0.02)
+    , m_maxGames(std::numeric_limits<SgUctValue>::max())
+    , m_maxTime(std::numeric_limits<double>::max())
+    , m_nextCheck(0)
+    , m_stoppedEarly(false)
+    , m_stopReason("limit")
+    , m_adaptiveExpandThreshold(true)
+    , m_baseExpandThreshold(1)
+    , m_maxExpandThreshold(1)
+    , m_lastNuNodes(0)
+    , m_numPrunes(0)
+    , m_useSymmetryPruning(true)
+    , m_useMustplay(true)
+    , m_rootSeed(0)
+    , m_endgameDb(0)
+    , m_leafSolveEmpty(8)
+    , m_leafSolveMustplay(2)
+    , m_leafSolveNodes(1000)
+    , m_leafSolverTable(LEAF_SOLVER_TABLE_BITS)
 {
     SetMoveSelect(SG_UCTMOVESELECT_COUNT);
     SetNumberThreads(1);    
@@ -302,6 +612,7 @@ YUctSearch::YUctSearch(YUctThreadStateFactory* threadStateFactory)
     SetRaveWeightInitial(1.0);
     SetRaveWeightFinal(20000.0);
     SetMaxNodes(2000000000 / sizeof(SgUctNode) / 2); // 2GB of memory
+    SetPruneFullTree(true);
 }
  
 YUctSearch::~YUctSearch()
@@ -323,27 +634,160 @@ void YUctSearch::OnSearchIteration(SgUctValue gameNumber,
                                    const SgUctGameInfo& info)
 {
     SgUctSearch::OnSearchIteration(gameNumber, threadId, info);
-    if (m_liveGfx && threadId == 0 && gameNumber > m_nextLiveGfx)
+    if (threadId == 0 && gameNumber >= m_nextCheck)
     {
-        m_nextLiveGfx = gameNumber + Statistics().m_gamesPerSecond;
-        std::ostringstream os;
-        os << "gogui-gfx:\n";
-        os << "uct\n";
-        SgBlackWhite toPlay = m_brd.ToPlay();
-        YUctSearchUtil::GoGuiGfx(*this, toPlay, m_brd.Const(), os);
-        os << '\n';
-        std::cout << os.str();
-        std::cout.flush();
+        m_nextCheck = gameNumber + CHECK_INTERVAL;
+        CheckTreeSize();
+        if (m_earlyStop && ! m_stoppedEarly)
+        {
+            const char* reason = CheckEarlyStop(gameNumber);
+            if (reason != 0)
+            {
+                m_stopReason = reason;
+                m_stoppedEarly = true;
+            }
+        }
+    }
+    if (threadId == 0 && m_reporter.WantsSnapshot())
+    {
+        YUctSearchUtil::TakeSnapshot(*this, m_brd.ToPlay(), 
+                                     m_timer.GetTime(), m_snapshot);
+        m_reporter.Publish(m_snapshot);
     }
 }
 
 void YUctSearch::OnStartSearch()
 {
-    m_nextLiveGfx = 1000;
+    m_nextCheck = 0;
+    m_stoppedEarly = false;
+    m_stopReason = "limit";
+    m_timer.Start();
+    m_baseExpandThreshold = ExpandThreshold();
+    m_maxExpandThreshold = m_baseExpandThreshold;
+    m_lastNuNodes = 0;
+    m_numPrunes = 0;
+    if (m_liveGfx || m_progressStream)
+        m_reporter.Start(m_brd.Const(), m_liveGfx, m_progressStream,
+                         m_reportInterval);
+}
+
+/** Counts prunes (SgUctSearch replaces a full tree with a smaller
+    copy) and raises the expand threshold as the tree fills: it stays
+    at the configured value up to half of MaxNodes and then grows
+    linearly to 16 times that value at MaxNodes. */
+void YUctSearch::CheckTreeSize()
+{
+    const std::size_t nuNodes = Tree().NuNodes();
+    if (nuNodes < m_lastNuNodes)
+        ++m_numPrunes;
+    m_lastNuNodes = nuNodes;
+    if (! m_adaptiveExpandThreshold)
+        return;
+    const double fill = static_cast<double>(nuNodes) / MaxNodes();
+    SgUctValue threshold = m_baseExpandThreshold;
+    if (fill > 0.5)
+    {
+        const double growth = 1.0 + 30.0 * (std::min(fill, 1.0) - 0.5);
+        threshold = static_cast<SgUctValue>(threshold * growth);
+    }
+    if (threshold != ExpandThreshold())
+        SetExpandThreshold(threshold);
+    m_maxExpandThreshold = std::max(m_maxExpandThreshold, threshold);
 }
 
 void YUctSearch::OnEndSearch()
 {
+    if (m_reporter.IsRunning())
+    {
+        YUctSearchUtil::TakeSnapshot(*this, m_brd.ToPlay(), 
+                                     m_timer.GetTime(), m_snapshot);
+        m_reporter.Stop(m_snapshot);
+    }
+    // All threads have stopped, so their counters can be collected
+    // without any synchronization.
+    for (unsigned int i = 0; i < NumberThreads(); ++i)
+    {
+        YUctThreadState& state 
+            = dynamic_cast<YUctThreadState&>(ThreadState(i));
+        m_playoutStats.Add(state.GetPlayoutStatistics());
+        m_boardStats.Add(state.GetBoardStatistics());
+        state.ClearStatistics();
+    }
+    SetExpandThreshold(m_baseExpandThreshold);
+    m_maxGames = std::numeric_limits<SgUctValue>::max();
+    m_maxTime = std::numeric_limits<double>::max();
+}
+
+void YUctSearch::SetUseTranspositions(bool f)
+{
+    if (f == UseTranspositions())
+        return;
+    if (f)
+        m_transpositions.reset(
+            new YTranspositionTable(TRANSPOSITION_TABLE_BITS));
+    else
+        m_transpositions.reset();
+}
+
+void YUctSearch::SetSearchLimits(SgUctValue maxGames, double maxTime)
+{
+    m_maxGames = maxGames;
+    m_maxTime = maxTime;
+}
+
+/** Returns the reason to stop, or 0 to continue. The root children
+    are read without locking, as SgUctSearch does itself. */
+const char* YUctSearch::CheckEarlyStop(SgUctValue gameNumber) const
+{
+    const SgUctNode& root = Tree().Root();
+    if (root.IsProven())
+        return "proven";
+    if (! root.HasChildren())
+        return 0;
+    const SgUctNode* best = 0;
+    SgUctValue secondCount = 0;
+    for (SgUctChildIterator it(Tree(), root); it; ++it)
+    {
+        const SgUctNode& child = *it;
+        if (best == 0 || child.MoveCount() > best->MoveCount())
+        {
+            if (best != 0)
+                secondCount = best->MoveCount();
+            best = &child;
+        }
+        else if (child.MoveCount() > secondCount)
+            secondCount = child.MoveCount();
+    }
+    if (best->MoveCount() >= EARLY_STOP_MIN_COUNT && best->HasMean()
+        && (best->Mean() >= 1.0 - m_earlyStopWinRate
+            || best->Mean() <= m_earlyStopWinRate))
+        return "win_rate";
+    // Games left at the rate of this search so far.
+    const double elapsed = m_timer.GetTime();
+    if (elapsed <= 0 || gameNumber <= 0)
+        return 0;
+    SgUctValue gamesLeft = m_maxGames - gameNumber;
+    if (m_maxTime < std::numeric_limits<double>::max())
+        gamesLeft = std::min(gamesLeft, static_cast<SgUctValue>(
+                             (m_maxTime - elapsed) * gameNumber / elapsed));
+    if (best->MoveCount() - secondCount > gamesLeft)
+        return "move_decided";
+    return 0;
+}
+
+void YUctSearch::WriteStatistics(std::ostream& out) const
+{
+    SgUctSearch::WriteStatistics(out);
+    out << "StopReason     " << m_stopReason << '\n';
+    if (PruneFullTree())
+        out << "Prunes         " << m_numPrunes << '\n';
+    if (m_adaptiveExpandThreshold)
+        out << "ExpandMax      " << m_maxExpandThreshold << '\n';
+}
+
+bool YUctSearch::CheckAbortSearch()
+{
+    return m_stoppedEarly || SgUctSearch::CheckAbortSearch();
 }
 
 void YUctSearch::OnThreadStartSearch(YUctThreadState& state)
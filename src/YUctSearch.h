@@ -9,8 +9,18 @@
 #include "SgUctSearch.h"
 #include "SgUctTree.h"
 #include "SgRandom.h"
+#include "SgTimer.h"
 #include "Board.h"
+#include "LockstepPlayouts.h"
+#include "PlayoutBoard.h"
 #include "WeightedRandom.h"
+#include "YAnalysisCache.h"
+#include "YDfpnSolver.h"
+#include "YEndgameDb.h"
+#include "YSearchReporter.h"
+#include "YTranspositionTable.h"
+
+#include <boost/scoped_ptr.hpp>
 
 //----------------------------------------------------------------------------
 
@@ -20,6 +30,66 @@ class YUctSearch;
 class YUctThreadState : public SgUctThreadState
 {
 public:
+    struct PlayoutStatistics
+    {
+        size_t m_localMoves;
+        size_t m_globalMoves;
+        size_t m_totalMoves;
+        size_t m_vcTerminations;
+        size_t m_lightMoves;
+        size_t m_lockstepGames;
+        size_t m_transpositionHits;
+        size_t m_leafSolves;
+        size_t m_leafSolved;
+
+        PlayoutStatistics()
+        { 
+            Clear(); 
+        }
+
+        void Clear()
+        {
+            m_localMoves = 0;
+            m_globalMoves = 0;
+            m_totalMoves = 0;
+            m_vcTerminations = 0;
+            m_lightMoves = 0;
+            m_lockstepGames = 0;
+            m_transpositionHits = 0;
+            m_leafSolves = 0;
+            m_leafSolved = 0;
+        }
+
+        void Add(const PlayoutStatistics& other)
+        {
+            m_localMoves += other.m_localMoves;
+            m_globalMoves += other.m_globalMoves;
+            m_totalMoves += other.m_totalMoves;
+            m_vcTerminations += other.m_vcTerminations;
+            m_lightMoves += other.m_lightMoves;
+            m_lockstepGames += other.m_lockstepGames;
+            m_transpositionHits += other.m_transpositionHits;
+            m_leafSolves += other.m_leafSolves;
+            m_leafSolved += other.m_leafSolved;
+        }
+
+        std::string ToString() const
+        {
+            std::ostringstream os;
+            os << '['
+               << "local_moves=" << m_localMoves << ' '
+               << "global_moves=" << m_globalMoves << ' '
+               << "total_moves=" << m_totalMoves << ' '
+               << "vc_terminations=" << m_vcTerminations << ' '
+               << "light_moves=" << m_lightMoves << ' '
+               << "lockstep_games=" << m_lockstepGames << ' '
+               << "transposition_hits=" << m_transpositionHits << ' '
+               << "leaf_solves=" << m_leafSolves << ' '
+               << "leaf_solved=" << m_leafSolved
+               << ']';
+            return os.str();
+        }
+    };
 
     YUctThreadState(const YUctSearch& search, const unsigned int threadId);
 
@@ -63,11 +133,33 @@ public:
 
     void StartPlayout(const Board& other);
 
+    /** Sets the initial value and RAVE value of each move from the
+        board knowledge of the current position. */
+    void ComputePriors(std::vector<SgUctMoveInfo>& moves);
+
+    /** Replaces the initial value of each move whose resulting
+        position is in the transposition table by the table's
+        statistics. */
+    void ApplyTranspositions(std::vector<SgUctMoveInfo>& moves);
+
+    /** Replaces the initial value of each root move that is in the
+        search's root seed by the cached statistics, with the count
+        capped by YAnalysisCache::SeedCount(). */
+    void ApplyRootSeed(std::vector<SgUctMoveInfo>& moves);
+
     /** Fills weights with weight for each move.
         Call after GenerateMove(). */
     void GetWeightsForLastMove(std::vector<float>& weights, 
                                SgBlackWhite toPlay) const;
 
+    const PlayoutStatistics& GetPlayoutStatistics() const
+    { return m_stats.m_playout; }
+
+    const Board::Statistics& GetBoardStatistics() const
+    { return m_stats.m_board; }
+
+    void ClearStatistics();
+
 
  private:
 
@@ -81,10 +173,67 @@ public:
 
     LocalMoves m_localMoves;
 
+    /** Board used once the playout switches to light moves. */
+    PlayoutBoard m_light;
+
+    bool m_inLightPlayout;
+
+    LockstepPlayouts m_lockstep;
+
+    /** Evaluate() runs lockstep playouts from m_light. */
+    bool m_inLockstep;
+
+    /** Playout moves played on m_brd in the current playout. */
+    int m_numPlayoutMoves;
+
+    /** Winner of the position the playout started from, if it is in
+        the endgame database; the playout then has no moves. */
+    SgBoardColor m_endgameWinner;
+
+    /** Solves tree leaves near the end of the game; shares the table
+        of the search. */
+    YDfpnSolver m_leafSolver;
+
+    /** Log weight of each move; scratch space for ComputePriors(). */
+    std::vector<float> m_priorLogWeights;
+
+    struct TreePosition
+    {
+        SgHashCode m_hash;
+
+        SgBlackWhite m_toPlay;
+    };
+
+    /** Positions after each in-tree move of the current game; their
+        transposition table entries get the result of the game. */
+    std::vector<TreePosition> m_treePositions;
+
+    SgUctValue EvaluatePlayout(SgBlackWhite& toPlay);
+
+    bool IsRoot() const;
+
+    bool WantsLeafSolve(bool restricted, const MarkedCells& mustplay) const;
+
+    SgUctProvenType SolveLeaf();
+
+    void UpdateTranspositions(SgUctValue blackValue);
+
+    /** Counters written on every playout move. Padded on both sides
+        so that no two threads ever write to the same cache line. */
+    struct Statistics
+    {
+        char m_padBefore[Y_CACHE_LINE_SIZE];
+        PlayoutStatistics m_playout;
+        Board::Statistics m_board;
+        char m_padAfter[Y_CACHE_LINE_SIZE];
+    };
+
+    Statistics m_stats;
+
     void ComputeWeight(cell_t p);
     void InitializeWeights();
-    SgMove GenerateLocalMove();
-    SgMove GenerateGlobalMove();
+    void SwitchToLightPlayout();
+    SgMove GenerateLightPlayoutMove();
 
 };
 
@@ -110,41 +259,7 @@ public:
 class YUctSearch : public SgUctSearch
 {
 public:
-    struct PlayoutStatistics
-    {
-        size_t m_localMoves;
-        size_t m_globalMoves;
-        size_t m_totalMoves;
-
-        PlayoutStatistics()
-        { 
-            Clear(); 
-        }
-
-        void Clear()
-        {
-            m_localMoves = 0;
-            m_globalMoves = 0;
-            m_totalMoves = 0;
-        }
-
-        std::string ToString() const
-        {
-            std::ostringstream os;
-            os << '['
-               << "local_moves=" << m_localMoves << ' '
-               << "global_moves=" << m_globalMoves << ' '
-               << "total_moves=" << m_totalMoves
-               << ']';
-            return os.str();
-        }
-
-        static PlayoutStatistics& Get()
-        {
-            static PlayoutStatistics s_stats;
-            return s_stats;
-        }
-    };
+    typedef YUctThreadState::PlayoutStatistics PlayoutStatistics;
 
     YUctSearch(YUctThreadStateFactory* threadStateFactory);
 
@@ -174,26 +289,247 @@ public:
 
     void OnThreadEndSearch(YUctThreadState& state);
 
+    /** Also true after an early stop. The early stop does not use
+        SgSetUserAbort(), so an interrupt arriving at the same time is
+        not lost. */
+    bool CheckAbortSearch();
+
     // @} // name
 
     void SetPosition(const Board& brd);
 
     const Board& GetBoard() const;
 
+    /** Calls SgUctSearch::WriteStatistics() and adds the reason the
+        last search stopped. */
+    void WriteStatistics(std::ostream& out) const;
+
+    /** Limits passed to the next Search(); used by the early stop to
+        estimate how many games are left. */
+    void SetSearchLimits(SgUctValue maxGames, double maxTime);
+
+    /** Stop the search before its limits if the root is proven, the
+        best move's win rate is within EarlyStopWinRate() of 0 or 1,
+        or its visit lead over the second-best move cannot be
+        overturned in the games that are left. */
+    bool EarlyStop() const        { return m_earlyStop; }
+    void SetEarlyStop(bool f)     { m_earlyStop = f; }
+
+    SgUctValue EarlyStopWinRate() const      { return m_earlyStopWinRate; }
+    void SetEarlyStopWinRate(SgUctValue v)   { m_earlyStopWinRate = v; }
+
+    /** Why the last search stopped: "limit" if it used up its time
+        or games (or was interrupted), otherwise "proven", "win_rate"
+        or "move_decided". */
+    const std::string& StopReason() const { return m_stopReason; }
+
+    /** Raise the expand threshold during a search as the tree fills
+        up, so that the remaining nodes go to the most visited
+        lines. */
+    bool AdaptiveExpandThreshold() const    
+    { return m_adaptiveExpandThreshold; }
+    void SetAdaptiveExpandThreshold(bool f) 
+    { m_adaptiveExpandThreshold = f; }
+
+    /** Share game results between tree nodes that reach the same
+        position through different move orders. Positions are keyed
+        on Board::Hash() and the player to move; Y has no symmetry
+        canonical hash. Must not be changed during a search. */
+    bool UseTranspositions() const { return m_transpositions.get() != 0; }
+    void SetUseTranspositions(bool f);
+
+    /** The shared table; 0 if transpositions are not used. */
+    YTranspositionTable* Transpositions() const 
+    { return m_transpositions.get(); }
+
+    /** Cached root statistics of an earlier search of the position;
+        the root moves start with their cached counts and values.
+        0 if there is none. The entry must stay valid until the
+        search ends. */
+    const YAnalysisCache::Entry* RootSeed() const { return m_rootSeed; }
+    void SetRootSeed(const YAnalysisCache::Entry* entry) 
+    { m_rootSeed = entry; }
+
+    /** Tree nodes in the database are proven and playouts from
+        positions in it return their exact result. 0 for none. */
+    const YEndgameDb* EndgameDb() const { return m_endgameDb; }
+    void SetEndgameDb(const YEndgameDb* db) { m_endgameDb = db; }
+
+    /** Generate one move per class of moves that are equivalent under
+        the symmetries of the position. The skipped moves are not
+        needed: the representative is itself a legal move. */
+    bool UseSymmetryPruning() const    { return m_useSymmetryPruning; }
+    void SetUseSymmetryPruning(bool f) { m_useSymmetryPruning = f; }
+
+    /** Generate only the mustplay when the opponent has a move that
+        wins with a VC (see Board::ComputeMustplay()); a node where
+        every move loses is a proven loss. */
+    bool UseMustplay() const    { return m_useMustplay; }
+    void SetUseMustplay(bool f) { m_useMustplay = f; }
+
+    /** Tree leaves with at most this many empty cells are solved
+        with a df-pn search of at most LeafSolveNodes() positions when
+        they are expanded; a solved leaf becomes a proven node and
+        SgUctSearch propagates the result up the tree. 0 turns it
+        off. */
+    int LeafSolveEmpty() const    { return m_leafSolveEmpty; }
+    void SetLeafSolveEmpty(int n) { m_leafSolveEmpty = n; }
+
+    /** Leaves whose mustplay has at most this many cells are solved
+        as well, however many cells are empty. 0 turns it off. */
+    int LeafSolveMustplay() const    { return m_leafSolveMustplay; }
+    void SetLeafSolveMustplay(int n) { m_leafSolveMustplay = n; }
+
+    std::size_t LeafSolveNodes() const    { return m_leafSolveNodes; }
+    void SetLeafSolveNodes(std::size_t n) { m_leafSolveNodes = n; }
+
+    /** Df-pn table of the leaf solvers of all threads; kept between
+        searches. */
+    YDfpnTable& LeafSolverTable() const { return m_leafSolverTable; }
+
+    /** Number of times the last search pruned its full tree. */
+    int NumPrunes() const { return m_numPrunes; }
+
     bool UseSaveBridge() const    { return m_useSaveBridge; }
     void SetUseSaveBridge(bool f) { m_useSaveBridge = f; }
 
+    /** Write GoGui live graphics during the search. */
     bool LiveGfx() const          { return m_liveGfx; }
     void SetLiveGfx(bool f)       { m_liveGfx = f; }
 
+    /** Write a line of JSON with the root statistics to std::cerr
+        during the search. */
+    bool ProgressStream() const    { return m_progressStream; }
+    void SetProgressStream(bool f) { m_progressStream = f; }
+
+    /** Seconds between two reports of live graphics or progress. */
+    double ReportInterval() const    { return m_reportInterval; }
+    void SetReportInterval(double s) { m_reportInterval = s; }
+
+    /** Stop playouts as soon as either player has a winning VC and
+        score the VC winner, instead of filling in carriers until the
+        game is solidly won. */
+    bool UseVCTermination() const    { return m_useVCTermination; }
+    void SetUseVCTermination(bool f) { m_useVCTermination = f; }
+
+    /** Number of playout moves played on the full board before the
+        playout continues on a PlayoutBoard with random moves (and
+        SaveBridge replies if enabled). 0 uses light playouts
+        throughout; a negative value never switches. */
+    int LightPlayoutAfter() const      { return m_lightPlayoutAfter; }
+    void SetLightPlayoutAfter(int n)   { m_lightPlayoutAfter = n; }
+
+    /** Number of random games played in lockstep from each leaf;
+        the leaf is scored with their average. 0 disables this and
+        uses the normal single playout. At most
+        LockstepPlayouts::MAX_LANES. */
+    int LockstepLanes() const          { return m_lockstepLanes; }
+    void SetLockstepLanes(int n)       { m_lockstepLanes = n; }
+
+    /** Number of virtual games given to each new child, with a value
+        taken from Board::WeightCell() and SaveBridge replies.
+        0 disables the prior. */
+    SgUctValue PriorCount() const         { return m_priorCount; }
+    void SetPriorCount(SgUctValue n)      { m_priorCount = n; }
+
+    /** Number of virtual RAVE games initialized with the same prior.
+        Their influence fades as real RAVE samples come in, which
+        gives a progressive bias towards the knowledge moves.
+        0 disables it. */
+    SgUctValue ProgressiveBias() const    { return m_progressiveBias; }
+    void SetProgressiveBias(SgUctValue n) { m_progressiveBias = n; }
+
+    /** Playout counters summed over all threads and searches. */
+    const PlayoutStatistics& GetPlayoutStatistics() const
+    { return m_playoutStats; }
+
+    /** Board counters summed over all threads and searches. */
+    const Board::Statistics& GetBoardStatistics() const
+    { return m_boardStats; }
+
 private:
     Board m_brd;
 
+    PlayoutStatistics m_playoutStats;
+
+    Board::Statistics m_boardStats;
+
     bool m_useSaveBridge;
 
     bool m_liveGfx;
 
-    SgUctValue m_nextLiveGfx;
+    bool m_useVCTermination;
+
+    int m_lightPlayoutAfter;
+
+    int m_lockstepLanes;
+
+    SgUctValue m_priorCount;
+
+    SgUctValue m_progressiveBias;
+
+    bool m_progressStream;
+
+    double m_reportInterval;
+
+    /** Formats live graphics and progress; runs only during a search
+        with either of them enabled. */
+    YSearchReporter m_reporter;
+
+    /** Scratch space of thread 0 for m_reporter. */
+    YUctSearchUtil::Snapshot m_snapshot;
+
+    bool m_earlyStop;
+
+    SgUctValue m_earlyStopWinRate;
+
+    SgUctValue m_maxGames;
+
+    double m_maxTime;
+
+    SgTimer m_timer;
+
+    SgUctValue m_nextCheck;
+
+    /** Set by thread 0 when it stops the search early; read by
+        CheckAbortSearch() in all threads. */
+    volatile bool m_stoppedEarly;
+
+    std::string m_stopReason;
+
+    bool m_adaptiveExpandThreshold;
+
+    /** ExpandThreshold() at the start of the search; restored at the
+        end. */
+    SgUctValue m_baseExpandThreshold;
+
+    SgUctValue m_maxExpandThreshold;
+
+    std::size_t m_lastNuNodes;
+
+    int m_numPrunes;
+
+    boost::scoped_ptr<YTranspositionTable> m_transpositions;
+
+    bool m_useSymmetryPruning;
+
+    bool m_useMustplay;
+
+    const YAnalysisCache::Entry* m_rootSeed;
+
+    const YEndgameDb* m_endgameDb;
+
+    int m_leafSolveEmpty;
+
+    int m_leafSolveMustplay;
+
+    std::size_t m_leafSolveNodes;
+
+    mutable YDfpnTable m_leafSolverTable;
+
+    const char* CheckEarlyStop(SgUctValue gameNumber) const;
+
+    void CheckTreeSize();
 };
 
 inline void YUctSearch::SetPosition(const Board& brd)
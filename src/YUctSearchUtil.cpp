@@ -9,31 +9,33 @@
 #include "SgUctSearch.h"
 
 #include "YUctSearchUtil.h"
+#include "YException.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <stdint.h>
 
 //----------------------------------------------------------------------------
 
 namespace {
 
-void GoGuiGfxStatus(const SgUctSearch& search, std::ostream& out)
+void GoGuiGfxStatus(const YUctSearchUtil::Snapshot& snapshot, 
+                    std::ostream& out)
 {
-    const SgUctTree& tree = search.Tree();
-    const SgUctNode& root = tree.Root();
-    const SgUctSearchStat& stat = search.Statistics();
     out << std::fixed
-        << "TEXT N=" << static_cast<size_t>(root.MoveCount())
-        << " V=" << std::setprecision(2) << root.Mean()
-        << " Len=" << static_cast<int>(stat.m_gameLength.Mean())
-        << " Tree=" << std::setprecision(1) << stat.m_movesInTree.Mean()
-        << "/" << static_cast<int>(stat.m_movesInTree.Max())
-#if 0
-        // one of our local fuego extensions
-        << " Know=" << std::setprecision(1) << stat.m_knowledgeDepth.Mean()
-        << "/" << static_cast<int>(stat.m_knowledgeDepth.Max())
-#endif
-        << " Gm/s=" << static_cast<int>(stat.m_gamesPerSecond) << '\n';
+        << "TEXT N=" << static_cast<size_t>(snapshot.m_games)
+        << " V=" << std::setprecision(2) << snapshot.m_value
+        << " Len=" << static_cast<int>(snapshot.m_gameLength)
+        << " Tree=" << std::setprecision(1) << snapshot.m_movesInTree
+        << "/" << static_cast<int>(snapshot.m_maxMovesInTree)
+        << " Gm/s=" << static_cast<int>(snapshot.m_gamesPerSecond) << '\n';
+}
+
+bool MoreGames(const YUctSearchUtil::Snapshot::Child& a,
+               const YUctSearchUtil::Snapshot::Child& b)
+{
+    return a.m_count > b.m_count;
 }
 
 }
@@ -50,52 +52,110 @@ const char* YUctSearchUtil::CleanCount(std::size_t count)
     return str;
 }
 
-void YUctSearchUtil::GoGuiGfx(const SgUctSearch& search, SgBlackWhite toPlay,
-                              const ConstBoard& cbrd, std::ostream& out)
+void YUctSearchUtil::TakeSnapshot(const SgUctSearch& search, 
+                                  SgBlackWhite toPlay, double elapsed,
+                                  Snapshot& snapshot)
 {
     const SgUctTree& tree = search.Tree();
     const SgUctNode& root = tree.Root();
+    const SgUctSearchStat& stat = search.Statistics();
+    snapshot.m_toPlay = toPlay;
+    snapshot.m_games = root.MoveCount();
+    snapshot.m_value = root.HasMean() ? root.Mean() : 0.5;
+    snapshot.m_elapsed = elapsed;
+    snapshot.m_gamesPerSecond = stat.m_gamesPerSecond;
+    snapshot.m_gameLength = stat.m_gameLength.Mean();
+    snapshot.m_movesInTree = stat.m_movesInTree.Mean();
+    snapshot.m_maxMovesInTree = stat.m_movesInTree.Max();
+    snapshot.m_variation.clear();
+    const SgUctNode* node = search.FindBestChild(root);
+    for (int i = 0; i < 4 && node != 0; ++i)
+    {
+        snapshot.m_variation.push_back(node->Move());
+        node = search.FindBestChild(*node);
+    }
+    snapshot.m_children.clear();
+    for (SgUctChildIterator it(tree, root); it; ++it)
+    {
+        const SgUctNode& child = *it;
+        Snapshot::Child c;
+        c.m_move = child.Move();
+        c.m_count = child.MoveCount();
+        c.m_mean = child.MoveCount() > 0 ? child.Mean() : 0.5;
+        snapshot.m_children.push_back(c);
+    }
+}
+
+void YUctSearchUtil::GoGuiGfx(const SgUctSearch& search, SgBlackWhite toPlay,
+                              const ConstBoard& cbrd, std::ostream& out)
+{
+    Snapshot snapshot;
+    TakeSnapshot(search, toPlay, 0.0, snapshot);
+    GoGuiGfx(snapshot, cbrd, out);
+}
+
+void YUctSearchUtil::GoGuiGfx(const Snapshot& snapshot, 
+                              const ConstBoard& cbrd, std::ostream& out)
+{
     out << "VAR";
-    std::vector<const SgUctNode*> bestValueChild;
-    bestValueChild.push_back(search.FindBestChild(root));
-    for (int i = 0; i < 4; i++) 
+    SgBlackWhite color = snapshot.m_toPlay;
+    for (std::size_t i = 0; i < snapshot.m_variation.size(); ++i)
     {
-	if (bestValueChild[i] == 0) 
-            break;
-	SgPoint move = bestValueChild[i]->Move();
-	if (0 == (i % 2))
-	    out << ' ' << (toPlay == SG_BLACK ? 'B' : 'W') << ' '
-		<< cbrd.ToString(move);
-	else
-	    out << ' ' << (toPlay == SG_WHITE ? 'B' : 'W') << ' '
-		<< cbrd.ToString(move);
-	bestValueChild.push_back(search.FindBestChild(*(bestValueChild[i])));
+        out << ' ' << (color == SG_BLACK ? 'B' : 'W') << ' '
+            << cbrd.ToString(snapshot.m_variation[i]);
+        color = SgOppBW(color);
     }
     out << "\n";
     out << "INFLUENCE";
-    for (SgUctChildIterator it(tree, root); it; ++it)
+    for (std::size_t i = 0; i < snapshot.m_children.size(); ++i)
     {
-        const SgUctNode& child = *it;
-        if (child.MoveCount() == 0)
+        const Snapshot::Child& child = snapshot.m_children[i];
+        if (child.m_count == 0)
             continue;
-        SgUctValue influence = search.InverseEval(child.Mean());
-        SgPoint move = child.Move();
-        out << ' ' << cbrd.ToString(move) 
+        // Influence is shown for the opponent, like 
+        // SgUctSearch::InverseEval().
+        SgUctValue influence = 1 - child.m_mean;
+        out << ' ' << cbrd.ToString(child.m_move) 
             << " ." << FixedValue(influence, 3);
     }
     out << '\n'
         << "LABEL";
-    int numChildren = 0;
-    for (SgUctChildIterator it(tree, root); it; ++it)
+    for (std::size_t i = 0; i < snapshot.m_children.size(); ++i)
     {
-        const SgUctNode& child = *it;
-        size_t count = static_cast<size_t>(child.MoveCount());
-	numChildren++;
-	out << ' ' << cbrd.ToString(child.Move())
+        const Snapshot::Child& child = snapshot.m_children[i];
+        size_t count = static_cast<size_t>(child.m_count);
+	out << ' ' << cbrd.ToString(child.m_move)
 	    << ' ' << CleanCount(count);
     }
     out << '\n';
-    GoGuiGfxStatus(search, out);
+    GoGuiGfxStatus(snapshot, out);
+}
+
+void YUctSearchUtil::WriteProgress(const Snapshot& snapshot, 
+                                   const ConstBoard& cbrd, std::ostream& out)
+{
+    std::vector<Snapshot::Child> children(snapshot.m_children);
+    std::stable_sort(children.begin(), children.end(), MoreGames);
+    out << std::fixed << std::setprecision(4)
+        << "{\"games\":" << static_cast<size_t>(snapshot.m_games)
+        << ",\"value\":" << snapshot.m_value
+        << ",\"elapsed\":" << std::setprecision(2) << snapshot.m_elapsed
+        << ",\"gps\":" << static_cast<size_t>(snapshot.m_gamesPerSecond)
+        << ",\"pv\":[";
+    for (std::size_t i = 0; i < snapshot.m_variation.size(); ++i)
+        out << (i > 0 ? "," : "") 
+            << '"' << cbrd.ToString(snapshot.m_variation[i]) << '"';
+    out << "],\"moves\":[" << std::setprecision(4);
+    for (std::size_t i = 0; i < children.size(); ++i)
+    {
+        if (children[i].m_count == 0)
+            break;
+        out << (i > 0 ? "," : "")
+            << "{\"move\":\"" << cbrd.ToString(children[i].m_move)
+            << "\",\"count\":" << static_cast<size_t>(children[i].m_count)
+            << ",\"value\":" << children[i].m_mean << '}';
+    }
+    out << "]}\n";
 }
 
 int YUctSearchUtil::ComputeMaxNumMoves()
@@ -158,31 +218,177 @@ void SaveNode(std::ostream& out, const SgUctTree& tree, const SgUctNode& node,
     }
 }
 
+const uint32_t DUMP_MAGIC = 0x59555431; // "YUT1"
+
+struct DumpHeader
+{
+    uint32_t m_magic;
+
+    int32_t m_size;
+
+    int32_t m_toPlay;
+
+    int32_t m_unused;
+
+    uint64_t m_key;
+};
+
+struct NodeRecord
+{
+    int16_t m_move;
+
+    uint8_t m_numChildren;
+
+    uint8_t m_provenType;
+
+    float m_moveCount;
+
+    float m_mean;
+
+    float m_posCount;
+
+    float m_raveCount;
+
+    float m_raveValue;
+};
+
+uint64_t DumpKey(const Board& brd, SgBlackWhite toPlay)
+{
+    const SgHashCode hash = brd.Hash();
+    const uint64_t key = (static_cast<uint64_t>(hash.Code2()) << 32)
+        | hash.Code1();
+    return toPlay == SG_WHITE ? ~key : key;
+}
+
+void WriteRecord(std::ostream& out, const SgUctNode& node)
+{
+    NodeRecord record;
+    record.m_move = static_cast<int16_t>(node.Move());
+    record.m_numChildren = static_cast<uint8_t>(node.NuChildren());
+    record.m_provenType = static_cast<uint8_t>(node.ProvenType());
+    record.m_moveCount = static_cast<float>(node.MoveCount());
+    record.m_mean = node.HasMean() ? static_cast<float>(node.Mean()) : 0.5f;
+    record.m_posCount = static_cast<float>(node.PosCount());
+    record.m_raveCount = static_cast<float>(node.RaveCount());
+    record.m_raveValue = node.HasRaveValue() 
+        ? static_cast<float>(node.RaveValue()) : 0.5f;
+    out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+}
+
+void DumpChildren(std::ostream& out, const SgUctTree& tree, 
+                  const SgUctNode& node)
+{
+    if (! node.HasChildren())
+        return;
+    for (SgUctChildIterator it(tree, node); it; ++it)
+        WriteRecord(out, *it);
+    for (SgUctChildIterator it(tree, node); it && out; ++it)
+        DumpChildren(out, tree, *it);
+}
+
+/** Reads the block of numChildren records of the children of node
+    and then the blocks of their subtrees. Allocators are used in
+    turn, so that the tree can fill all of them. */
+void LoadChildren(std::istream& in, SgUctTree& tree, const SgUctNode& node,
+                  int numChildren, std::size_t& allocatorId)
+{
+    if (numChildren == 0)
+        return;
+    std::vector<NodeRecord> records(numChildren);
+    if (! in.read(reinterpret_cast<char*>(&records[0]), 
+                  numChildren * sizeof(NodeRecord)))
+        throw YException() << "Truncated tree dump";
+    std::vector<SgUctMoveInfo> moves;
+    for (int i = 0; i < numChildren; ++i)
+    {
+        const NodeRecord& r = records[i];
+        moves.push_back(SgUctMoveInfo(r.m_move, r.m_mean, r.m_moveCount,
+                                      r.m_raveValue, r.m_raveCount));
+    }
+    std::size_t i = 0;
+    while (! tree.HasCapacity(allocatorId, numChildren))
+    {
+        allocatorId = (allocatorId + 1) % tree.NuAllocators();
+        if (++i == tree.NuAllocators())
+            throw YException() << "Tree dump does not fit in max_nodes";
+    }
+    tree.CreateChildren(allocatorId, node, moves);
+    allocatorId = (allocatorId + 1) % tree.NuAllocators();
+    std::vector<const SgUctNode*> children;
+    for (SgUctChildIterator it(tree, node); it; ++it)
+        children.push_back(&(*it));
+    for (int j = 0; j < numChildren; ++j)
+    {
+        tree.SetPosCount(*children[j], records[j].m_posCount);
+        tree.SetProvenType(*children[j], static_cast<SgUctProvenType>(
+                                         records[j].m_provenType));
+    }
+    for (int j = 0; j < numChildren; ++j)
+        LoadChildren(in, tree, *children[j], records[j].m_numChildren,
+                     allocatorId);
+}
+
 }
 
-#if 0
-void YUctSearchUtil::SaveTree(const SgUctTree& tree, const StoneBoard& brd, 
-                              SgBlackWhite toPlay, std::ostream& out, int maxDepth)
+void YUctSearchUtil::SaveTree(const SgUctTree& tree, const Board& brd, 
+                              SgBlackWhite toPlay, std::ostream& out, 
+                              int maxDepth)
 {
-    out << "(;FF[4]GM[11]SZ[" << brd.Width() << "]\n";
+    out << "(;FF[4]GM[11]SZ[" << brd.Size() << "]\n";
     out << ";AB";
-    for (BitsetIterator it(brd.GetBlack()); it; ++it)
-        out << '[' << *it << ']';
+    for (CellIterator it(brd); it; ++it)
+        if (brd.GetColor(*it) == SG_BLACK)
+            out << '[' << brd.ToString(*it) << ']';
     out << '\n';
     out << "AW";
-    for (BitsetIterator it(brd.GetWhite()); it; ++it)
-        out << '[' << *it << ']';
-    out << '\n';
-    out << "AE";
-    for (BitsetIterator it(brd.GetEmpty()); it; ++it)
-        out << '[' << *it << ']';
+    for (CellIterator it(brd); it; ++it)
+        if (brd.GetColor(*it) == SG_WHITE)
+            out << '[' << brd.ToString(*it) << ']';
     out << '\n';
     out << "PL[" << (toPlay == SG_BLACK ? "B" : "W") << "]\n";
-    SaveNode(out, tree, tree.Root(), toPlay, maxDepth, 0);
+    SaveNode(out, tree, tree.Root(), toPlay, brd.Const(), maxDepth, 0);
     out << ")\n";
 }
-#endif
 
-//----------------------------------------------------------------------------
+void YUctSearchUtil::DumpTree(const SgUctTree& tree, const Board& brd,
+                              SgBlackWhite toPlay, std::ostream& out)
+{
+    DumpHeader header;
+    header.m_magic = DUMP_MAGIC;
+    header.m_size = brd.Size();
+    header.m_toPlay = toPlay;
+    header.m_unused = 0;
+    header.m_key = DumpKey(brd, toPlay);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WriteRecord(out, tree.Root());
+    DumpChildren(out, tree, tree.Root());
+    if (! out)
+        throw YException() << "Cannot write tree";
+}
 
+SgBlackWhite YUctSearchUtil::LoadTree(SgUctTree& tree, const Board& brd, 
+                                      std::istream& in)
+{
+    DumpHeader header;
+    if (! in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || header.m_magic != DUMP_MAGIC)
+        throw YException() << "Not a tree dump";
+    const SgBlackWhite toPlay = header.m_toPlay;
+    if (   header.m_size != brd.Size() || ! SgIsBlackWhite(toPlay)
+        || header.m_key != DumpKey(brd, toPlay))
+        throw YException() << "Tree dump is of another position";
+    NodeRecord root;
+    if (! in.read(reinterpret_cast<char*>(&root), sizeof(root)))
+        throw YException() << "Truncated tree dump";
+    tree.Clear();
+    if (root.m_moveCount > 0)
+        tree.InitializeValue(tree.Root(), root.m_mean, root.m_moveCount);
+    tree.SetPosCount(tree.Root(), root.m_posCount);
+    tree.SetProvenType(tree.Root(), 
+                       static_cast<SgUctProvenType>(root.m_provenType));
+    std::size_t allocatorId = 0;
+    LoadChildren(in, tree, tree.Root(), root.m_numChildren, allocatorId);
+    return toPlay;
+}
 
+//----------------------------------------------------------------------------
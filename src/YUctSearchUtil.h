@@ -9,6 +9,9 @@
 #include "SgPoint.h"
 #include "SgUctSearch.h"
 #include "Board.h"
+
+#include <vector>
+
 //----------------------------------------------------------------------------
 
 /** General utility functions used in GoUct.
@@ -16,6 +19,50 @@
     in GoUct to avoid cyclic dependencies. */
 namespace YUctSearchUtil
 {
+    /** Copy of the root statistics of a running search, so that they
+        can be formatted outside the search threads. */
+    struct Snapshot
+    {
+        struct Child
+        {
+            SgMove m_move;
+
+            SgUctValue m_count;
+
+            /** Value for the player to move at the root; only valid
+                if m_count > 0. */
+            SgUctValue m_mean;
+        };
+
+        SgBlackWhite m_toPlay;
+
+        /** Games at the root. */
+        SgUctValue m_games;
+
+        SgUctValue m_value;
+
+        double m_elapsed;
+
+        SgUctValue m_gamesPerSecond;
+
+        SgUctValue m_gameLength;
+
+        SgUctValue m_movesInTree;
+
+        SgUctValue m_maxMovesInTree;
+
+        /** Best moves by value, starting with the root player. */
+        std::vector<SgMove> m_variation;
+
+        std::vector<Child> m_children;
+    };
+
+    /** Fills snapshot from the tree of search. The tree is read
+        without locking, as SgUctSearch does itself, so call this from
+        a search thread or after the search. */
+    void TakeSnapshot(const SgUctSearch& search, SgBlackWhite toPlay,
+                      double elapsed, Snapshot& snapshot);
+
     /** Print information about search as Gfx commands for GoGui.
         Can be used for GoGui live graphics during the search or GoGui
         analyze command type "gfx" after the search (see http://gogui.sf.net).
@@ -40,6 +87,17 @@ namespace YUctSearchUtil
     */
     void GoGuiGfx(const SgUctSearch& search, SgBlackWhite toPlay,
                   const ConstBoard& cbrd, std::ostream& out);
+
+    /** GoGuiGfx() from a snapshot. */
+    void GoGuiGfx(const Snapshot& snapshot, const ConstBoard& cbrd,
+                  std::ostream& out);
+
+    /** Writes a snapshot as one line of JSON: 
+        {"games":N,"value":V,"elapsed":S,"gps":G,"pv":["a1",...],
+         "moves":[{"move":"a1","count":N,"value":V},...]}
+        with the moves sorted by count. */
+    void WriteProgress(const Snapshot& snapshot, const ConstBoard& cbrd,
+                       std::ostream& out);
     
     /** RAVE is more efficient if we know the max number of moves we
 	can have. Simply returns Y_MAX_CELL. */
@@ -51,11 +109,28 @@ namespace YUctSearchUtil
     /** Returns a human readable count. */
     const char* CleanCount(std::size_t count);
     
-#if 0
-    /** Saves the uct tree to an sgf. */
-    void SaveTree(const SgUctTree& tree, const StoneBoard& brd, 
-                  HexColor toPlay, std::ostream& out, int maxDepth);
-#endif
+    /** Saves the uct tree to an sgf, with the statistics of each node
+        as comments and labels. Stops below maxDepth; -1 saves the
+        whole tree, which is only practical for small trees. */
+    void SaveTree(const SgUctTree& tree, const Board& brd, 
+                  SgBlackWhite toPlay, std::ostream& out, int maxDepth);
+
+    /** Writes the whole tree in a compact binary format, in one pass
+        over the tree: a header with the position, then the root and,
+        recursively, the children of each node as one block before the
+        blocks of their subtrees. Each node takes 24 bytes: move, number
+        of children, proven type, and move count, mean, position count,
+        RAVE count and RAVE value as floats, in host byte order. Throws
+        YException if writing fails. */
+    void DumpTree(const SgUctTree& tree, const Board& brd,
+                  SgBlackWhite toPlay, std::ostream& out);
+
+    /** Rebuilds a tree written by DumpTree() in tree, which must have
+        its allocators, and returns the color to play at its root.
+        Throws YException if the dump is not of the position on brd or
+        does not fit in tree. */
+    SgBlackWhite LoadTree(SgUctTree& tree, const Board& brd, 
+                          std::istream& in);
 }
 
 inline int YUctSearchUtil::FixedValue(double value, int precision)